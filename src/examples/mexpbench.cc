@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+using namespace std;
+
+#include "globl.h"
+#include "multiexp.h"
+#include "benchmark.h"
+
+#include "fmt/format.h"
+
+// Compares the multiexp methods on random inputs.
+// Usage: mexpbench [MIN_D [MAX_D]] (sizes are 2^d; LEGO_MEXP_WINDOW fixes the Pippenger window)
+
+const int NREPS = 1;
+
+template<typename G>
+vector<G> random_bases(size_t n)
+{
+  vector<G> ret(n);
+  for (auto i = 0; i < n; i++) {
+    ret[i] = LFr::random_element()*G::one();
+  }
+  return ret;
+}
+
+vector<LFr> random_scalars(size_t n)
+{
+  vector<LFr> ret(n);
+  for (auto i = 0; i < n; i++) {
+    ret[i] = LFr::random_element();
+  }
+  return ret;
+}
+
+template<typename G>
+void bench_methods(string grpName, size_t n, const vector<cpmexp::Method> &methods)
+{
+  auto gs = random_bases<G>(n);
+  auto xs = random_scalars(n);
+
+  G expected;
+  bool first = true;
+  for (auto m : methods) {
+    cpmexp::forceMethod(m);
+    G res;
+    auto t = TimeDelta::runAndAverage([&]() { res = multiExp<G>(gs, xs); }, NREPS);
+    if (first) {
+      expected = res;
+      first = false;
+    }
+    fmt_time(fmt::format("##mexp {} {} (n={})", grpName, cpmexp::methodName(m), n), t);
+    MYREQUIRE(res == expected);
+  }
+  cpmexp::forceMethod(cpmexp::Method::Auto);
+}
+
+// multiExpMA on affine G1 bases (as in the keys): mixed-addition buckets vs batch-affine ones
+void bench_batch_affine(size_t n)
+{
+  auto gs = random_bases<LG1>(n);
+  libff::batch_to_special(gs);
+  auto xs = random_scalars(n);
+
+  LG1 resMixed, resAffine;
+  auto tMixed = TimeDelta::runAndAverage([&]() { resMixed = multiExpMA<LG1>(gs, xs); }, NREPS);
+  auto tAffine = TimeDelta::runAndAverage([&]() {
+    resAffine = multiExpMA<LG1>(gs, xs, "mexpbench", cpmexp::Method::BatchAffine); }, NREPS);
+  fmt_time(fmt::format("##mexpMA G1 affine bases, mixed additions (n={})", n), tMixed);
+  fmt_time(fmt::format("##mexpMA G1 affine bases, batch-affine buckets (n={})", n), tAffine);
+  MYREQUIRE(resMixed == resAffine);
+}
+
+// batch-affine buckets against Pippenger on scalars whose digits repeat (witness-like inputs)
+void bench_batch_affine_degenerate(size_t n)
+{
+  auto gs = random_bases<LG1>(n);
+  libff::batch_to_special(gs);
+  const LFr k = LFr::random_element();
+
+  vector<pair<string, vector<LFr>>> cases {
+    { "all zero", vector<LFr>(n, LFr::zero()) },
+    { "all one", vector<LFr>(n, LFr::one()) },
+    { "0/1", vector<LFr>(n) },
+    { "all equal", vector<LFr>(n, k) } };
+  for (auto &x : cases[2].second) {
+    x = (rand() & 1) ? LFr::one() : LFr::zero();
+  }
+
+  for (auto &cs : cases) {
+    LG1 resPip, resAffine;
+    auto tPip = TimeDelta::runAndAverage([&]() {
+      resPip = multiExpMA<LG1>(gs, cs.second, "mexpbench", cpmexp::Method::Pippenger); }, NREPS);
+    auto tAffine = TimeDelta::runAndAverage([&]() {
+      resAffine = multiExpMA<LG1>(gs, cs.second, "mexpbench", cpmexp::Method::BatchAffine); }, NREPS);
+    fmt_time(fmt::format("##mexpMA G1 {} scalars, pippenger (n={})", cs.first, n), tPip);
+    fmt_time(fmt::format("##mexpMA G1 {} scalars, batch-affine buckets (n={})", cs.first, n), tAffine);
+    MYREQUIRE(resPip == resAffine);
+  }
+}
+
+// G1 Pippenger with and without the GLV split of the scalars
+void bench_glv(size_t n)
+{
+  auto gs = random_bases<LG1>(n);
+  auto xs = random_scalars(n);
+
+  LG1 resPlain, resGLV;
+  cpmexp::forceMethod(cpmexp::Method::Pippenger);
+  cpmexp::useGLV(false);
+  auto tPlain = TimeDelta::runAndAverage([&]() { resPlain = multiExp<LG1>(gs, xs); }, NREPS);
+  cpmexp::useGLV(true);
+  auto tGLV = TimeDelta::runAndAverage([&]() { resGLV = multiExp<LG1>(gs, xs); }, NREPS);
+  cpmexp::forceMethod(cpmexp::Method::Auto);
+  fmt_time(fmt::format("##mexp G1 pippenger without GLV (n={})", n), tPlain);
+  fmt_time(fmt::format("##mexp G1 pippenger with GLV (n={})", n), tGLV);
+  MYREQUIRE(resPlain == resGLV);
+}
+
+// G1 multiexp on 32-bit scalars (as the matrix examples' witnesses) against full-size ones
+void bench_small_scalars(size_t n)
+{
+  auto gs = random_bases<LG1>(n);
+  auto xsFull = random_scalars(n);
+  vector<LFr> xsSmall(n);
+  for (auto i = 0; i < n; i++) {
+    xsSmall[i] = LFr::one()*(unsigned)rand();
+  }
+
+  LG1 resSmall, resHint;
+  auto tFull = TimeDelta::runAndAverage([&]() { multiExp<LG1>(gs, xsFull); }, NREPS);
+  auto tSmall = TimeDelta::runAndAverage([&]() { resSmall = multiExp<LG1>(gs, xsSmall); }, NREPS);
+  auto tHint = TimeDelta::runAndAverage([&]() {
+    cpmexp::ScalarBitsHint hint(32);
+    resHint = multiExp<LG1>(gs, xsSmall); }, NREPS);
+  fmt_time(fmt::format("##mexp G1 254-bit scalars (n={})", n), tFull);
+  fmt_time(fmt::format("##mexp G1 32-bit scalars (n={})", n), tSmall);
+  fmt_time(fmt::format("##mexp G1 32-bit scalars, bits hint (n={})", n), tHint);
+  MYREQUIRE(resSmall == resHint);
+}
+
+int main(int argc, char **argv)
+{
+  default_ec_pp::init_public_params();
+
+  size_t MIN_D, MAX_D;
+  MIN_D = MAX_D = 10;
+
+  if (argc == 2) {
+    MIN_D = MAX_D = stoi(argv[1]);
+  } else if (argc == 3) {
+    MIN_D = stoi(argv[1]);
+    MAX_D = stoi(argv[2]);
+  }
+
+  vector<cpmexp::Method> methods {
+    cpmexp::Method::BosCoster, cpmexp::Method::BDLO12, cpmexp::Method::Pippenger };
+  auto g1Methods = methods;
+  g1Methods.push_back(cpmexp::Method::BatchAffine);
+
+  for (size_t d = MIN_D; d <= MAX_D; d++) {
+    const uint64 n = 1 << d;
+    cout << "## Multiexp size: " << n
+         << " (Pippenger window: " << cpmexp::pippengerWindow(n, LFr::size_in_bits(), true) << ")" << endl;
+
+    bench_methods<LG1>("G1", n, g1Methods);
+    bench_methods<LG2>("G2", n, methods);
+    bench_batch_affine(n);
+    bench_batch_affine_degenerate(n);
+    bench_glv(n);
+    bench_small_scalars(n);
+    cout << "## ## ##" << endl;
+  }
+
+  return 0;
+}
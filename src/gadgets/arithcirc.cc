@@ -35,7 +35,7 @@ template<typename T>
 void mkSubspaceMatrixVEq(
 	size_t nComms,
 	const RCPairs &posW, const vector<T> &valsW,
-	const T &h0, const vector<vector<T>> &bases,
+	const T &h0, const vector<cputil::Span<T>> &bases,
 	vector<vector<CoeffPos<T>>> &M)
 {
   
@@ -109,7 +109,7 @@ ACKey* CPAC::keygen(const ACRel *rel)
 	auto n = rel->n_mul_gates;
 	ACKey *crs = new ACKey;
 	
-	startBenchmark("keygen_comm");
+	startBenchmark("keygen_srs");
 	auto ics = dynamic_cast<InterpCommScheme *>(getCommScheme());
 	if (!ics) {
 
@@ -126,15 +126,19 @@ ACKey* CPAC::keygen(const ACRel *rel)
 	IScalar chi = IScalar::random_element();
 	IScalar gamma = IScalar::random_element();
 
-	ics->keygen(n, *interp, chi, gamma);
+	auto srs = mkLSrs(n, *interp, chi, gamma); // one pass for both keys
+	stopBenchmark("keygen_srs");
+
+	startBenchmark("keygen_comm");
+	ics->keygen(srs);
 	stopBenchmark("keygen_comm");
 	
-	cphadl.keygen(n, *interp, chi, gamma);
+	startBenchmark("keygen_had");
+	cphadl.keygen(srs);
 	crs->hadkey = &cphadl.key;
+	stopBenchmark("keygen_had");
 	// end joint kg for commitment/hadamard
 	
-	applyBenchmarkFrom(cphadl, "keygen", "keygen_had");
-	
 	cout << "Finished KG Had\n";
 	
 	// let us compute W in G1
@@ -173,15 +177,14 @@ ACKey* CPAC::keygen(const ACRel *rel)
   // simple book-keeping of data structures here
 	SubspaceRel *ssrel = 
     new SubspaceRel(ssR, ssC, vector<ColFr>(ssC), vector<ColG1>(ssC), C_precomp_sz, interp); 
-  vector<vector<LG1>> g1_bases;
-  vector<vector<LFr>> sc_bases;
+  // views into the commitment key: the bases are only copied into the matrices
+  vector<cputil::Span<LG1>> g1_bases;
+  vector<cputil::Span<LFr>> sc_bases;
   for (auto i = 0; i < nComms; i++) {
     if (i == 3) { // nComms == 4 
       // put special base
-      vector<LG1> g1_ubase(ics->key.lg1.begin(), ics->key.lg1.begin()+rel->input_size);
-      g1_bases.push_back(g1_ubase);
-      vector<LFr> sc_ubase(ics->key.l.begin(), ics->key.l.begin()+rel->input_size);
-      sc_bases.push_back(sc_ubase);
+      g1_bases.push_back(cputil::Span<LG1>(ics->key.lg1).first(rel->input_size));
+      sc_bases.push_back(cputil::Span<LFr>(ics->key.l).first(rel->input_size));
     } else {
       g1_bases.push_back(ics->key.lg1);
       sc_bases.push_back(ics->key.l);
@@ -226,12 +229,12 @@ ACPf* CPAC::prove(const ACKey *crs, const ACPIn &in)
     w.push_back(in.uCOut.r);
   }
 	vector<LFr> abc =
-		cputil::concat3(in.aCOut.xs, in.bCOut.xs, in.cCOut.xs);
+		cputil::concat3(in.aCOut.vals(), in.bCOut.vals(), in.cCOut.vals());
   if (crs->input_size != 0) { // if we have u
-    abc.insert(abc.end(), in.uCOut.xs.begin(), in.uCOut.xs.end());
+    abc.insert(abc.end(), in.uCOut.vals().begin(), in.uCOut.vals().end());
   }
 	w.insert(w.end(), abc.begin(), abc.end()); 
-	auto aSize = in.aCOut.xs.size();
+	auto aSize = in.aCOut.vals().size();
 
 	
 	startBenchmark("prove_veq");
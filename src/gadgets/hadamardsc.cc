@@ -83,7 +83,7 @@ HadPf* CPHad::prove(const HadKey *crs, const CPPIn &in)
 
 	// poly proof for result
 	startBenchmark("prove_cppoly");
-	cppolyProve(cppoly, u[0], hadPf->r, uProdEvalCmOut, hadPf->polyProof);
+	cppolyProve(cppoly, *u[0], hadPf->r, uProdEvalCmOut, hadPf->polyProof);
 	stopBenchmark("prove_cppoly");
 	// sumcheck proof
 	scInput.commSlot[0] = uProdEvalCmOut; // Because it's just been initialized
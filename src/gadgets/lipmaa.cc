@@ -1,4 +1,5 @@
 #include "lipmaa.h"
+#include "memstat.h"
 
 #include <algorithm>
 using std::multiplies;
@@ -7,6 +8,51 @@ using std::transform;
 #include <iostream>
 using namespace std;
 
+LSrs mkLSrs(long n, Interpolator &interp, IScalar chi, IScalar gamma, unsigned parts)
+{
+	const bool comm = parts & LSrs::Comm;
+	const bool had = parts & LSrs::Had;
+
+	LSrs srs;
+	srs.n = n;
+	srs.z = interp.mkZ(chi);
+	srs.zg1 = srs.z*LG1::one();
+	srs.gammazg2 = (gamma*srs.z)*LG2::one();
+
+	// scalars first (cheap), then all exponentiations as concurrent tasks
+	IScalars gammal;
+	if (comm) {
+		srs.l = interp.getAllLagrangianPolys(chi);
+		gammal = cputil::map<IScalar,IScalar>(srs.l, [gamma](const IScalar &x) { return x*gamma; });
+	}
+	IScalars chiPows;
+	if (had) {
+		chiPows.resize(n); // chi^1..chi^n; chi^0*g1 is put in front below
+		chiPows[0] = chi;
+		for (auto i = 1; i < n; i++) {
+			chiPows[i] = chi*chiPows[i-1];
+		}
+	}
+
+	vector<std::function<void()>> tasks;
+	if (comm) {
+		tasks.push_back([&]() { srs.lg1 = interp.mkG1Exp(srs.l); normalizeBases(srs.lg1); });
+		tasks.push_back([&]() { srs.gammalg2 = interp.mkG2Exp(gammal); normalizeBases(srs.gammalg2); });
+	}
+	if (had) {
+		tasks.push_back([&]() {
+			auto pows = interp.mkG1Exp(chiPows);
+			normalizeBases(pows);
+			srs.chipowsg1.reserve(n+1);
+			srs.chipowsg1.push_back(LG1::one());
+			srs.chipowsg1.insert(srs.chipowsg1.end(), pows.begin(), pows.end());
+		});
+	}
+	cppool::parallelFor(tasks.size(), [&](size_t t) { tasks[t](); }, 1);
+
+	return srs;
+}
+
 void LGlobalKeygen(long n, InterpCommScheme &ics, CPHadL &cphadl)
 {
 	Interpolator interp(n);
@@ -14,19 +60,49 @@ void LGlobalKeygen(long n, InterpCommScheme &ics, CPHadL &cphadl)
    IScalar chi = IScalar::random_element();
    IScalar gamma = IScalar::random_element();
 
-	ics.keygen(n, interp, chi, gamma);
-	
-	cphadl.keygen(n, interp, chi, gamma);	
+	auto srs = mkLSrs(n, interp, chi, gamma);
+	ics.keygen(srs);
+	cphadl.keygen(srs);
 }
 
 CommOut InterpCommScheme::commit(const IScalars &v)
 {
-	auto r = IScalar::random_element();
 	startBenchmark("commit");
-	LG1 c = r*key.zg1 + multiExpMA<LG1>(key.lg1, v); // commitment: multiexp of lg1[i]-s on v[i]-s (+ randomness)
-	KCT kc = r*key.gammazg2 + multiExpMA<LG2>(key.gammalg2, v); // XXX: can be optimized with kc_method
+	// commitment: multiexp of lg1[i]-s on v[i]-s (+ randomness)
+	auto out = cachedCommit(v, [this, &v]() { return commitOnce(std::make_shared<const IScalars>(v)); }); // kc as set by setKCMode
 	stopBenchmark("commit");
-	return CommOut(Comm(c, kc), r, v);
+	return out;
+}
+
+void InterpCommScheme::saveKey(const std::string &path) const
+{
+	cpkeyfile::Writer w(path, cpkeyfile::Kind::InterpCommKey);
+	w.value(key.zg1);
+	w.value(key.z);
+	w.value(key.gammazg2);
+	w.array<LG1>(key.lg1);
+	w.array<LFr>(key.l);
+	w.array<LG2>(key.gammalg2);
+	w.close();
+}
+
+void InterpCommScheme::loadKey(const std::string &path)
+{
+	cpkeyfile::Reader r(path, cpkeyfile::Kind::InterpCommKey);
+	key.zg1 = r.value<LG1>();
+	key.z = r.value<LFr>();
+	key.gammazg2 = r.value<LG2>();
+	key.lg1 = r.array<LG1>();
+	key.l = r.array<LFr>();
+	key.gammalg2 = r.array<LG2>();
+	n = key.lg1.size();
+	keyReady();
+}
+
+CommOut InterpCommScheme::blind(InsPtr v, const Comm &cm)
+{
+	auto r = IScalar::random_element();
+	return CommOut(Comm(r*key.zg1, r*key.gammazg2) + cm, r, v);
 }
 
 
@@ -35,7 +111,7 @@ bool InterpCommScheme::verify(const Comm &c)
 	GT<def_ec> lhs =
 		def_ec::reduced_pairing(c.c, key.gammazg2);	
 	GT<def_ec> rhs =	
-		def_ec::reduced_pairing(key.zg1, c.kc);
+		def_ec::reduced_pairing(key.zg1, c.getKC());
 
 	return lhs == rhs;
 }
@@ -65,20 +141,20 @@ void mkZ(long n, IScalars &p, const IScalar r)
 	p[0] = -r;
 }
 
-void divisionFast(long n, domain_ptr domain, IScalars &piCoeffs, const IScalars &QCoeffs, const IScalars &ZCoeffs)
+void divisionFast(long n, const cpdomain::Domain &domain, IScalars &piCoeffs, const IScalars &QCoeffs, const IScalars &ZCoeffs)
 {
 	// identity poly
-	IScalars oneCoeffs(n, IScalar::zero());
+	IScalars oneCoeffs(domain.m, IScalar::zero());
 	oneCoeffs[0] = IScalar::one();
 
 	IScalars onePts = oneCoeffs; // XXX: to optimize
-	domain->cosetFFT(onePts, IScalar::multiplicative_generator);
+	domain.cosetFFT(onePts);
 
 	IScalars ZinvPts = onePts; // XXX: to optimize 
-	domain->divide_by_Z_on_coset(ZinvPts);
+	domain.divideByZOnCoset(ZinvPts);
 
 	IScalars ZinvCoeffs = ZinvPts;
-	domain->icosetFFT(ZinvCoeffs, IScalar::multiplicative_generator);
+	domain.icosetFFT(ZinvCoeffs);
 
 	// Just a check
 	IScalars tstPoly;
@@ -91,93 +167,180 @@ void divisionFast(long n, domain_ptr domain, IScalars &piCoeffs, const IScalars
 }
 
 
-HadLPf CPHadL::prove(const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut)
+/* H = (A'B' - C')/Z for A' = A + d1*Z, B' = B + d2*Z, C' = C + d3*Z, i.e.
+ *   H = d2*A + d1*B - d3 + d1*d2*Z + (AB - C)/Z
+ * Transforms: iFFT of a, b and c; coset FFT of A and B; icosetFFT of the quotient.
+ * On a radix-2 domain Z is the constant zeta on the coset, so C/Z = C*zeta^-1 needs no coset FFT of C,
+ * and a == b (squares) saves the transforms of B: 6 transforms, 4 for squares. */
+IScalars CPHadL::quotient(const cpdomain::Domain &domain, const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut, cpmem::PeakTracker &mem)
 {
 	using FieldT = IScalar;
-	
-	startBenchmark("prove");
-
-	
-
-	auto domain = get_evaluation_domain<IScalar>(n);
-	std::vector<FieldT> coefficients_for_H(domain->m+1, FieldT::zero());
+	const size_t m = domain.m;
+	std::vector<FieldT> coefficients_for_H(m+1, FieldT::zero());
+	size_t nFFT = 0;
       {
 
 	// Point-form of a,b and c
-	auto &aPts = aCOut.xs;
-	auto &bPts = bCOut.xs;
-	auto &cPts = cCOut.xs;
+	auto &aPts = aCOut.vals();
+	auto &bPts = bCOut.vals();
+	auto &cPts = cCOut.vals();
+	const bool square = &aPts == &bPts || aPts == bPts;
 
 	// randomness
 	auto d1 = aCOut.r;
 	auto d2 = bCOut.r;
 	auto d3 = cCOut.r;
 	
-    std::vector<FieldT> aA(domain->m, FieldT::zero()), aB(domain->m, FieldT::zero());
+    auto padded = [&](const std::vector<FieldT> &pts) {
+        std::vector<FieldT> v(m, FieldT::zero());
+        std::copy(pts.begin(), pts.begin() + n, v.begin());
+        return v;
+    };
+    std::vector<FieldT> aA = padded(aPts), aB, aC = padded(cPts);
+    if (square) {
+        cppool::parallelInvoke({
+            [&]() { domain.iFFT(aA); },
+            [&]() { domain.iFFT(aC); } });
+        nFFT += 2;
+    } else {
+        aB = padded(bPts);
+        cppool::parallelInvoke({
+            [&]() { domain.iFFT(aA); },
+            [&]() { domain.iFFT(aB); },
+            [&]() { domain.iFFT(aC); } });
+        nFFT += 3;
+    }
+    const std::vector<FieldT> &coeffsB = square ? aA : aB;
+    mem.sample();
 
-    for (size_t i = 0; i < n; ++i)
+    /* coefficients of the polynomial (d2*A + d1*B - d3) + d1*d2*Z, and -C/zeta when Z is constant on the coset */
+    const bool zConst = domain.isRadix2();
+    const FieldT zInv = zConst ? domain.zInvOnCoset() : FieldT::zero();
+    cppool::parallelFor(m, [&](size_t i)
     {
-        aA[i] = aPts[i];
-        aB[i] = aPts[i];
+        coefficients_for_H[i] = d2*aA[i] + d1*coeffsB[i];
+        if (zConst) {
+            coefficients_for_H[i] -= zInv*aC[i];
+        }
+    }, cppool::FINE_GRAIN);
+    coefficients_for_H[0] -= d3;
+    domain.addPolyZ(d1*d2, coefficients_for_H);
+
+    if (square) {
+        domain.cosetFFT(aA);
+        nFFT += 1;
+    } else {
+        cppool::parallelInvoke({
+            [&]() { domain.cosetFFT(aA); },
+            [&]() { domain.cosetFFT(aB); } });
+        nFFT += 2;
     }
-    domain->iFFT(aA);
-    domain->iFFT(aB);
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-    /* add coefficients of the polynomial (d2*A + d1*B - d3) + d1*d2*Z */
-    for (size_t i = 0; i < domain->m; ++i)
-    {
-        coefficients_for_H[i] = d2*aA[i] + d1*aB[i];
+    if (!zConst) {
+        domain.cosetFFT(aC);
+        nFFT += 1;
     }
-    coefficients_for_H[0] -= d3;
-    domain->add_poly_Z(d1*d2, coefficients_for_H);
-
-    domain->cosetFFT(aA, FieldT::multiplicative_generator);
 
-    domain->cosetFFT(aB, FieldT::multiplicative_generator);
     std::vector<FieldT> &H_tmp = aA; // can overwrite aA because it is not used later
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < domain->m; ++i)
+    const std::vector<FieldT> &cosetB = square ? aA : aB;
+    cppool::parallelFor(m, [&](size_t i)
     {
-        H_tmp[i] = aA[i]*aB[i];
-    }
+        H_tmp[i] = zConst ? H_tmp[i]*cosetB[i] : H_tmp[i]*cosetB[i] - aC[i];
+    }, cppool::FINE_GRAIN);
     std::vector<FieldT>().swap(aB); // destroy aB
+    std::vector<FieldT>().swap(aC);
 
-    std::vector<FieldT> aC(domain->m, FieldT::zero());
-    for (size_t i = 0; i < n; ++i)
-    {
-        aC[i] += cPts[i];
+    if (!zConst) {
+        domain.divideByZOnCoset(H_tmp);
     }
+    domain.icosetFFT(H_tmp);
+    nFFT += 1;
 
-    domain->iFFT(aC);
-    domain->cosetFFT(aC, FieldT::multiplicative_generator);
-
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < domain->m; ++i)
+    cppool::parallelFor(m, [&](size_t i)
     {
-        H_tmp[i] = (H_tmp[i]-aC[i]);
-    }
+        coefficients_for_H[i] += zConst ? zInv*H_tmp[i] : H_tmp[i];
+    }, cppool::FINE_GRAIN);
+  }
+	lastFFTs = nFFT;
+	return coefficients_for_H;
+}
+
+/* Same quotient with at most two vectors of m elements alive (radix-2 domains only), at the price of
+ * running the transforms one after the other:
+ *   P = A*B on the coset, icosetFFT'd (b's buffer freed first),
+ *   L = iFFT(d2*a + d1*b - c/zeta) for the linear part (iFFT is linear, so C needs no transform of its own),
+ * then H = L + P/zeta - d3 + d1*d2*Z accumulated into L. Same transform count as quotient(). */
+IScalars CPHadL::quotientLowMem(const cpdomain::Domain &domain, const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut, cpmem::PeakTracker &mem)
+{
+	using FieldT = IScalar;
+	const size_t m = domain.m;
+	auto &aPts = aCOut.vals();
+	auto &bPts = bCOut.vals();
+	auto &cPts = cCOut.vals();
+	const bool square = &aPts == &bPts || aPts == bPts;
+	auto d1 = aCOut.r;
+	auto d2 = bCOut.r;
+	auto d3 = cCOut.r;
+	const FieldT zInv = domain.zInvOnCoset();
+	size_t nFFT = 0;
+
+	auto onCoset = [&](const std::vector<FieldT> &pts) {
+		std::vector<FieldT> v(m, FieldT::zero());
+		std::copy(pts.begin(), pts.begin() + n, v.begin());
+		domain.iFFT(v);
+		domain.cosetFFT(v);
+		nFFT += 2;
+		mem.sample();
+		return v;
+	};
+	std::vector<FieldT> P = onCoset(aPts);
+	if (square) {
+		cppool::parallelFor(m, [&](size_t i) { P[i] *= P[i]; }, cppool::FINE_GRAIN);
+	} else {
+		const std::vector<FieldT> B = onCoset(bPts);
+		cppool::parallelFor(m, [&](size_t i) { P[i] *= B[i]; }, cppool::FINE_GRAIN);
+	}
+	domain.icosetFFT(P);
+	nFFT += 1;
+
+	std::vector<FieldT> H;
+	H.reserve(m+1); // room for the Z term, no reallocation
+	H.resize(m, FieldT::zero());
+	cppool::parallelFor(n, [&](size_t i)
+	{
+		H[i] = d2*aPts[i] + d1*bPts[i] - zInv*cPts[i];
+	}, cppool::FINE_GRAIN);
+	domain.iFFT(H);
+	nFFT += 1;
+	mem.sample();
+
+	cppool::parallelFor(m, [&](size_t i)
+	{
+		H[i] += zInv*P[i];
+	}, cppool::FINE_GRAIN);
+	std::vector<FieldT>().swap(P);
+
+	H.push_back(FieldT::zero());
+	H[0] -= d3;
+	domain.addPolyZ(d1*d2, H);
+
+	lastFFTs = nFFT;
+	return H;
+}
 
-    domain->divide_by_Z_on_coset(H_tmp);
+HadLPf CPHadL::prove(const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut)
+{
+	startBenchmark("prove");
 
-    domain->icosetFFT(H_tmp, FieldT::multiplicative_generator);
+	cpmem::PeakTracker mem;
+	auto domain = cpdomain::get(n); // cached with its twiddles and coset powers
+	auto coefficients_for_H = (lowMemory && domain->isRadix2()) ?
+		quotientLowMem(*domain, aCOut, bCOut, cCOut, mem) :
+		quotient(*domain, aCOut, bCOut, cCOut, mem);
+	lastQuotientPeakBytes = mem.peakAboveStart();
 
-#ifdef MULTICORE
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < domain->m; ++i)
-    {
-        coefficients_for_H[i] += H_tmp[i];
-    }
-  }
-    
 	fmt::print("SZ of multiexp in Hadamard: {}\n", key.chipowsg1.size());
-	auto ret = multiExpMA<LG1>(key.chipowsg1, coefficients_for_H); 
+	auto ret = multiExpMA<LG1>(key.chipowsg1, coefficients_for_H, "hadamard.prove");
+	lastPeakBytes = mem.peakAboveStart();
 
 	stopBenchmark("prove");
 	
@@ -188,7 +351,7 @@ bool CPHadL::verify(HadLPf pf, const Comm &ca, const Comm &cb, const Comm &cc)
 {
 	startBenchmark("verify");
 	
-	auto cck_precomp = def_ec::precompute_G2(cc.kc);
+	auto cck_precomp = def_ec::precompute_G2(cc.getKC());
 	auto pf_precomp = def_ec::precompute_G1(pf);
 	
 	auto rhs = def_ec::double_miller_loop(
@@ -196,7 +359,7 @@ bool CPHadL::verify(HadLPf pf, const Comm &ca, const Comm &cb, const Comm &cc)
 		pf_precomp, key.gammazg2_precomp);
 	
 	auto ca_precomp = def_ec::precompute_G1(ca.c);
-	auto cbk_precomp = def_ec::precompute_G2(cb.kc);
+	auto cbk_precomp = def_ec::precompute_G2(cb.getKC());
 	auto lhs = def_ec::miller_loop(ca_precomp, cbk_precomp);
 
 	
@@ -3,6 +3,7 @@
 
 #include "interp.h"
 #include "commit.h"
+#include "memstat.h"
 
 
 
@@ -21,15 +22,37 @@ void print_poly(const vector<T> &c) {
 
 class CPHadL;
 
+/* Shared SRS of InterpCommScheme and CPHadL for trapdoors chi, gamma: chi powers, Lagrange evaluations
+ * and their gamma multiples are computed once, and their fixed-base exponentiations run concurrently.
+ * Only the requested parts are built; the interpolator's window table of a group nothing asks for is
+ * never computed. */
+struct LSrs {
+  enum Parts : unsigned { Comm = 1, Had = 2, All = Comm | Had };
+
+  long n;
+  LFr z;              // Z(chi)
+  LG1 zg1;
+  LG2 gammazg2;
+
+  IScalars l;         // L_i(chi)                  (Comm)
+  vector<LG1> lg1;    // L_i(chi)*g1, affine      (Comm)
+  vector<LG2> gammalg2; // gamma*L_i(chi)*g2, affine (Comm)
+
+  vector<LG1> chipowsg1; // chi^i*g1 for i = 0..n, affine (Had)
+};
+
+LSrs mkLSrs(long n, Interpolator &interp, IScalar chi, IScalar gamma, unsigned parts = LSrs::All);
+
+// the base vectors lg1, gammalg2 are kept in affine form (see normalizeBases); the arrays may be mapped from a key file
 struct InterpCommKey {
   LG1 zg1;
-  vector<LG1> lg1;
+  cpkeyfile::Array<LG1> lg1;
   
   LFr z;
-  vector<LFr> l;
+  cpkeyfile::Array<LFr> l;
 
   LG2 gammazg2;
-  vector<LG2> gammalg2;
+  cpkeyfile::Array<LG2> gammalg2;
 
 };
 
@@ -37,21 +60,27 @@ class InterpCommScheme : public CommScheme {
 public:
   void keygen(long _n, Interpolator &interp, IScalar chi, IScalar gamma)
   {
-		n = _n;
-		key.l = interp.getAllLagrangianPolys(chi);
-
-		key.lg1 = interp.mkG1Exp(key.l);
-		
-		key.z = interp.mkZ(chi);
-		key.zg1 = key.z*LG1::one();
-
-		key.gammazg2 = gamma*interp.mkZ(chi)*LG2::one();
+		auto srs = mkLSrs(_n, interp, chi, gamma, LSrs::Comm);
+		keygen(srs);
+  }
 
-		auto mulByGamma = [gamma](const IScalar &x) { return x*gamma; };
-		auto lEvalOnChiGamma = cputil::map<IScalar,IScalar>(key.l, mulByGamma);
-		key.gammalg2 = interp.mkG2Exp(lEvalOnChiGamma);
+  // takes the Comm part of srs
+  void keygen(LSrs &srs)
+  {
+		n = srs.n;
+		key.z = srs.z;
+		key.zg1 = srs.zg1;
+		key.gammazg2 = srs.gammazg2;
+		key.l = std::move(srs.l);
+		key.lg1 = std::move(srs.lg1);
+		key.gammalg2 = std::move(srs.gammalg2);
+
+		keyReady();
   }
 
+  void saveKey(const std::string &path) const override;
+  void loadKey(const std::string &path) override;
+
   friend void LGlobalKeygen(long n, InterpCommScheme &ics, CPHadL &cphadl);
   InterpCommKey key;
 
@@ -68,8 +97,17 @@ public:
   
   void print_key_size() {
     fmt::print("Commitment key Size: {} G1 + {} G2\n", key.lg1.size()+1, key.gammalg2.size()+1);
+    if (hasPrecomputation()) {
+      fmt::print("Fixed-base tables Size: {} G1 + {} G2\n", g1Tbl.sizeInPoints(), g2Tbl.sizeInPoints());
+    }
   }
 
+protected:
+  CommOut blind(InsPtr v, const Comm &cm) override;
+
+  cputil::Span<LG1> commitBases1() const override { return key.lg1; }
+  cputil::Span<LG2> commitBases2() const override { return key.gammalg2; }
+
 };
 
 using HadLPf = LG1;
@@ -86,25 +124,21 @@ class CPHadL : public Benchmarkable
 public:
  void keygen(long _n, Interpolator &interp, IScalar chi, IScalar gamma)
   {
-		n = _n;
-	
-		key.gammazg2 = gamma*interp.mkZ(chi)*LG2::one();
-		
 		startBenchmark("keygen");
+		auto srs = mkLSrs(_n, interp, chi, gamma, LSrs::Had);
+		keygen(srs);
+		stopBenchmark("keygen");
+  }
+
+  // takes the Had part of srs
+  void keygen(LSrs &srs)
+  {
+		n = srs.n;
+		key.gammazg2 = srs.gammazg2;
 
 		key.g1_precomp = def_ec::precompute_G1(LG1::one());
 		key.gammazg2_precomp = def_ec::precompute_G2(key.gammazg2);
-		
-		vector<IScalar> chiPows(n);
-		chiPows[0] = chi; // this will get shifted later at pos. 1
-		for (auto i = 1; i < n; i++) {
-			chiPows[i] = chi*chiPows[i-1];
-		}
-			
-		key.chipowsg1 = interp.mkG1Exp(chiPows);
-		stopBenchmark("keygen");
-
-		key.chipowsg1.insert(key.chipowsg1.begin(), LG1::one()); // NB: Would be O(1) with simple optimization
+		key.chipowsg1 = std::move(srs.chipowsg1);
   }
 
 	friend void LGlobalKeygen(long n, InterpCommScheme &ics, CPHadL &cphadl);
@@ -112,6 +146,23 @@ public:
 	HadLKey key;
 	long n;
 
+	// FFTs and inverse FFTs run by the last prove
+	size_t fftsPerProof() const { return lastFFTs; }
+
+	// peak resident memory of the last prove above what was resident before it. It includes other threads'
+	// allocations meanwhile, and is sampled between steps unless the prove sets a new process high-water mark
+	// (see memstat.h); the process's VmHWM is not reset.
+	size_t peakBytesPerProof() const { return lastPeakBytes; }
+	// the same up to the end of the quotient, before the multiexp (what setLowMemory changes)
+	size_t quotientPeakBytesPerProof() const { return lastQuotientPeakBytes; }
+
+	// prove with at most two m-sized quotient vectors alive instead of four plus concurrent FFT buffers,
+	// running the transforms one at a time (radix-2 domains; four-step transforms are in place for any
+	// log m, so they add no m-sized buffer). Not counted: the cached domain's tables
+	// (3m field elements, built by the first proof of each size and kept) and the final multiexp's
+	// working memory, the same in both modes.
+	void setLowMemory(bool on) { lowMemory = on; }
+
 	CPHadL() {}
   
   void print_key_size() {
@@ -121,6 +172,15 @@ public:
 	
 	HadLPf prove(const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut);
 	bool verify(HadLPf, const Comm&, const Comm&, const Comm&);
+
+private:
+	size_t lastFFTs = 0;
+	size_t lastPeakBytes = 0;
+	size_t lastQuotientPeakBytes = 0;
+	bool lowMemory = false;
+
+	IScalars quotient(const cpdomain::Domain &domain, const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut, cpmem::PeakTracker &mem);
+	IScalars quotientLowMem(const cpdomain::Domain &domain, const CommOut &aCOut, const CommOut &bCOut, const CommOut &cCOut, cpmem::PeakTracker &mem);
 };
 
 
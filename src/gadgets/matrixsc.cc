@@ -88,7 +88,7 @@ MatPf* CPMat::prove(const MatKey *crs, const CPPIn &in)
 
   // poly proof for result
   startBenchmark("prove_cppoly");
-  cppolyProve(cppoly, u[0], pf->r, uProdEvalCmOut, pf->polyProof);
+  cppolyProve(cppoly, *u[0], pf->r, uProdEvalCmOut, pf->polyProof);
   stopBenchmark("prove_cppoly");
 
   // sumcheck proof
@@ -137,7 +137,7 @@ MatPf* CPMat::proveOutputMatrixInClear(const MatKey *crs, const CPPIn &in)
 
   // poly proof for result
   startBenchmark("prove_cppoly");
-  cppoly->computeAnswer(uProdEvalCmOut, pf->getRndConcat(), u[0]);
+  cppoly->computeAnswer(uProdEvalCmOut, pf->getRndConcat(), *u[0]);
   stopBenchmark("prove_cppoly");
 
   // sumcheck proof
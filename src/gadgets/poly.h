@@ -32,7 +32,7 @@ public:
     }
 
     bool checkCommit(const Comm &cm) const {
-      return simple_pairing_check(cm.c, LG2::one(), LG1::one(), cm.kc);
+      return simple_pairing_check(cm.c, LG2::one(), LG1::one(), cm.getKC());
     }
 
 
@@ -69,22 +69,31 @@ public:
         pf.witness.resize(d);
         pf.witnessa.resize(d);
 
-        // NB: Putting g1 as bases; benchmark purposes only.
+        // NB: Putting g1 as bases; benchmark purposes only. (A view: the bases are not copied.)
         auto g1s = cmScm->getBases1();
 
-        // make multiexps
+        // make multiexps: the d quotient vectors are prefixes of the same bases, so we batch them
+        vector<Scalars> quots(d);
         start = 0;
         for (auto i = 0; i < d; i++) {
             uint64 pBound = 1 << (d-i-1);
-            Scalars tmp_e(pBound);
-            for (uint64 p = 0; p < pBound; p++) {
-                tmp_e[p] = w_coeffs[start+p];
+            quots[i].assign(w_coeffs.begin()+start, w_coeffs.begin()+start+pBound);
+            start += pBound;
+        }
+        vector<const Scalars *> allQuots, tailQuots;
+        for (auto i = 0; i < d; i++) {
+            allQuots.push_back(&quots[i]);
+            if (i != 0) {
+                tailQuots.push_back(&quots[i]);
             }
-            pf.witness[i] = multiExpMA<LG1>(g1s, tmp_e); // NB: bases for benchmarking purposes only
+        }
+        auto ws = multiExpMulti<LG1>(g1s, allQuots, "poly.witness"); // NB: bases for benchmarking purposes only
+        auto was = multiExpMulti<LG1>(g1s, tailQuots, "poly.witnessa"); // NB: bases for benchmarking purposes only
+        for (auto i = 0; i < d; i++) {
+            pf.witness[i] = ws[i];
             if (i != 0) {
-                pf.witnessa[i] = multiExpMA<LG1>(g1s, tmp_e); // NB: bases for benchmarking purposes only
+                pf.witnessa[i] = was[i-1];
             }
-            start += pBound;
         }
 
 
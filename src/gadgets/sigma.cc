@@ -9,7 +9,7 @@ ZKEqProof::ZKEqProof(CommScheme *_comScm, CommOut cOut0, CommOut cOut1) :
   h = comScm->getBlindingH();
 
   CommRand r = CommRand::random_element(); // this is Prover's randomness; no need for RO
-  a = r*h;
+  a = cpglv::mul(r, h);
 
   c = CommRand::random_element();
 
@@ -18,8 +18,8 @@ ZKEqProof::ZKEqProof(CommScheme *_comScm, CommOut cOut0, CommOut cOut1) :
 
 bool ZKEqProof::verify()
 {
-  auto lhs = z*h;
-  auto rhs = c*(c0-c1) + a;
+  auto lhs = cpglv::mul(z, h);
+  auto rhs = cpglv::mul(c, c0-c1) + a;
   return lhs == rhs;
 }
 
@@ -56,7 +56,7 @@ ZKPrdProof::ZKPrdProof(CommScheme *_comScm, CommOut cOut0, CommOut cOut1, CommOu
 
 bool ZKPrdProof::verify() const
 {
-  vector<LG1> lhs { alpha + c*c0, beta + c*c1, delta + c*cPrd };
+  vector<LG1> lhs { alpha + cpglv::mul(c, c0), beta + cpglv::mul(c, c1), delta + cpglv::mul(c, cPrd) };
   vector<LG1> rhs { ghPow(z1, z2), ghPow(z3, z4), ghPow(z3, z5)};
 
   for (auto i = 0; i < lhs.size(); i++) {
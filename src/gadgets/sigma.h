@@ -33,7 +33,7 @@ public:
 
   // returns g^x \cdot h^r
   LG1 ghPow(In x, CommRand r) const {
-    return x*LG1::one() + r*h;
+    return cpglv::mulMany<LG1, LFr>({x, r}, {LG1::one(), h});
   }
 
   ZKPrdProof(CommScheme *comScm, CommOut cOut0, CommOut cOut1, CommOut cOutPrd);
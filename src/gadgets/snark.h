@@ -67,9 +67,7 @@ class CPInputFmt
 public:
     static void init_no_pub(CPPIn &prvIn, CPVIn &vrfIn, CommScheme *commScm, const vector<Ins> &vecIns)
     {
-      auto vecComFn = [&commScm](const Ins &v) { return commScm->commit(v); };
-      CommOuts committedIns = cputil::map<Ins, CommOut>(vecIns, vecComFn);
-      prvIn.commSlot = committedIns;
+      prvIn.commSlot = commScm->commitBatch(vecIns); // independent inputs, committed concurrently
       vrfIn.commIn = CommOut::toComms(prvIn.commSlot);
     }
 
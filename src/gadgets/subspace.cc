@@ -56,6 +56,7 @@ SubspaceKey* SubspaceSnark::keygen(const SubspaceRel *rel)
   }
   
   assert(key->P.size() == rel->t);
+  normalizeBases(key->P);
   cpdbg::print(key->P, "P", "keygen");
 
   // C = a * k (C is a vector, k is a vector, a is Ec2 point)
@@ -79,7 +80,7 @@ SubspacePf* SubspaceSnark::prove(const SubspaceKey *crs, const vector<LFr> &w)
 {
   SubspacePf *pf = new SubspacePf;
   startBenchmark("prove");
-  *pf = multiExpMA<LG1>(crs->P, w);
+  *pf = multiExpMA<LG1>(crs->P, w, "subspace.prove");
   stopBenchmark("prove");
   return pf;
 }
@@ -51,7 +51,7 @@ struct SubspaceKey {
 
   const SubspaceRel *rel;
 
-  vector<LG1> P;
+  vector<LG1> P; // affine
   
   vector<LG2> C;
   vector<G2_precomp<def_ec>> C_precomp;
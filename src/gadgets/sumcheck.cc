@@ -23,12 +23,9 @@ SumcheckPf *CPSumcheck::prove(const SumcheckKey *crs, const CPPIn &in)
   auto c = CommOut::toComms(in.commSlot);
   auto u = CommOut::toCommittedVals(in.commSlot);
 
-  SumcheckField y = u[0][0]; // alleged result
+  SumcheckField y = (*u[0])[0]; // alleged result
   auto &yComOut = in.commSlot[0];
 
-  const Ins &a = u[1];
-  const Ins &b = u[2];
-
   const Ins &rho = in.publicSlot;
   assert(rho.size() == crs->d);
 
@@ -38,7 +35,7 @@ SumcheckPf *CPSumcheck::prove(const SumcheckKey *crs, const CPPIn &in)
   shared_ptr<DPBeta> beta = init_beta(crs->d, rho);
   // for i in 0 to n_cm_polys-1...
   vector<shared_ptr<DPMle>> mles;
-  init_mles(mles, crs->d, rho, a, b);
+  init_mles(mles, crs->d, rho, u[1], u[2]);
 
   // generate randomnesses
   SumcheckRand r(crs->d);
@@ -82,13 +79,13 @@ SumcheckPf *CPSumcheck::prove(const SumcheckKey *crs, const CPPIn &in)
   zComOut[0] = yComOut;
 
   for (auto i = 0; i < crs->d; i++) {
-    auto hComEvalOn0 = PolyT::evalAsPolyOn(hComOut[i], In::zero());
-    auto hComEvalOn1 = PolyT::evalAsPolyOn(hComOut[i], In::one());
-    auto vComOut = hComEvalOn0 + hComEvalOn1;
+    // h[i] at 0, 1 and r[i] in one pass over its coefficient commitments
+    auto hComEvals = PolyT::evalAsPolyOn(hComOut[i], Scalars{In::zero(), In::one(), r[i]});
+    auto vComOut = hComEvals[0] + hComEvals[1];
 
     eqPfs[i] = make_shared<ZKEqProof>(comScm, vComOut, zComOut[i]);
 
-    zComOut[i+1] = PolyT::evalAsPolyOn(hComOut[i], r[i]);
+    zComOut[i+1] = hComEvals[2];
   }
 
   /* Poly Proofs */
@@ -154,12 +151,11 @@ bool CPSumcheck::verify(const SumcheckKey *crs, const CPVIn &in, const SumcheckP
 
   for (auto i = 0; i < crs->d; i++)
   {
-    auto hComEvalOn0 = PolyT::evalAsPolyOn(hCom[i], In::zero());
-    auto hComEvalOn1 = PolyT::evalAsPolyOn(hCom[i], In::one());
-    auto vCom = hComEvalOn0 + hComEvalOn1;
+    auto hComEvals = PolyT::evalAsPolyOn(hCom[i], Scalars{In::zero(), In::one(), pf->r[i]});
+    auto vCom = hComEvals[0] + hComEvals[1];
     addCheck(checkEqPf(vCom, zCom[i], pf->eqPfs[i]));
 
-    zCom[i+1] = PolyT::evalAsPolyOn(hCom[i], pf->r[i]);
+    zCom[i+1] = hComEvals[2];
   }
 
 
@@ -76,7 +76,8 @@ public:
 		return make_shared<DPBeta>(d, rho);
 	}
 
-  virtual void init_mles(vector<shared_ptr<DPMle>> &mles, size_t d, const Ins &rho, const Ins &a, const Ins &b)
+  // a and b are the committed vectors, shared with the input CommOuts
+  virtual void init_mles(vector<shared_ptr<DPMle>> &mles, size_t d, const Ins &rho, InsPtr a, InsPtr b)
 	{
 		mles.push_back(make_shared<DPMle>(d, 1 << d, a));
 		mles.push_back(make_shared<DPMle>(d, 1 << d, b));
@@ -87,20 +88,30 @@ public:
 		// D = 1 + # of mle poly-s // If you have beta, a and b, then it's 3
 		// out_poly = empty_poly of degree D
 		size_t D = CPSumcheck::n_cm_polys;
-		PolyT out_poly = PolyT::zero(D);
-		auto bound_p = 1 << (d-j-1);
-		for (auto p = 0; p < bound_p; p++) {
-			PolyT beta_poly = beta->getBetaPoly(j, p);
-
-			// poly_p: polynomial increment depending on p
-			auto poly_p = beta_poly;
-
-			for (const shared_ptr<DPMle> mle : mles) {
-				PolyT mle_poly = mle->getMLEPoly(j, p);
-				poly_p = poly_p.mul(mle_poly);
+		uint64 bound_p = 1 << (d-j-1);
+
+		// each chunk sums the increments of a slice of p-s
+		size_t chunks = std::max<size_t>(1, min<uint64>(cppool::numThreads(), bound_p));
+		vector<PolyT> partial(chunks, PolyT::zero(D));
+		cppool::parallelFor(chunks, [&](size_t t) {
+			for (uint64 p = bound_p*t/chunks; p < bound_p*(t+1)/chunks; p++) {
+				PolyT beta_poly = beta->getBetaPoly(j, p);
+
+				// poly_p: polynomial increment depending on p
+				auto poly_p = beta_poly;
+
+				for (const shared_ptr<DPMle> &mle : mles) {
+					PolyT mle_poly = mle->getMLEPoly(j, p);
+					poly_p = poly_p.mul(mle_poly);
+				}
+				// update partial out_poly
+				partial[t] = partial[t].add(poly_p);
 			}
-			// update out_poly
-			out_poly = out_poly.add(poly_p);
+		});
+
+		PolyT out_poly = PolyT::zero(D);
+		for (auto &pp : partial) {
+			out_poly = out_poly.add(pp);
 		}
 		return out_poly;
 	}
@@ -121,11 +132,11 @@ public:
 		return make_shared<DPBetaDummy>();
 	}
 
-	virtual void init_mles(vector<shared_ptr<DPMle>> &mles, size_t d, const Ins &rho, const Ins &a, const Ins &b) override
+	virtual void init_mles(vector<shared_ptr<DPMle>> &mles, size_t d, const Ins &rho, InsPtr a, InsPtr b) override
 	{
 		// a and b represent matrices but we want sumcheck only on sqr(a.size()) bits
-		mles.push_back(make_shared<DPMatrixMle>(d, 1 << d, a, rho));
-		mles.push_back(make_shared<DPMatrixMle>(d, 1 << d, b, rho));
+		mles.push_back(make_shared<DPMatrixMle>(d, 1 << d, *a, rho));
+		mles.push_back(make_shared<DPMatrixMle>(d, 1 << d, *b, rho));
 	}
 
 };
@@ -1,18 +1,156 @@
 #include "commit.h"
 
+#include <cstdlib>
+#include <string>
+
 using namespace std;
 
 CommOut operator+(const CommOut& a, const CommOut& b)  {
     if (a.lenXs != 1 || b.lenXs != 1) {
     	throw runtime_error("Operations CommOut are only for commitments of single elements.");
     }
-    return CommOut(a.c+b.c, a.r+b.r, a.xs[0]+b.xs[0]);
+    return CommOut(a.c+b.c, a.r+b.r, a.val()+b.val());
 }
 
 CommOut operator-(const CommOut& a, const CommOut& b)  {
 	if (a.lenXs != 1 || b.lenXs != 1) {
     	throw runtime_error("Operations CommOut are only for commitments of single elements.");
    }
-   return CommOut(a.c-b.c, a.r-b.r, a.xs[0]-b.xs[0]);
+   return CommOut(a.c-b.c, a.r-b.r, a.val()-b.val());
+}
+
+
+void StreamCommitter::push(const Ins &chunk)
+{
+  if (chunk.empty()) {
+    return;
+  }
+  auto bases1 = cputil::Span<LG1>(scm.commitBases1());
+  if (pos + chunk.size() > bases1.size()) {
+    throw runtime_error("Streamed vector longer than the commitment key.");
+  }
+  c = c + multiExpMulti<LG1>(bases1.subspan(pos, chunk.size()), {&chunk}, "commitStream.c")[0];
+  if (scm.getKCMode() != KCMode::None) {
+    auto bases2 = cputil::Span<LG2>(scm.commitBases2());
+    kc = kc + multiExpMulti<LG2>(bases2.subspan(pos, chunk.size()), {&chunk}, "commitStream.kc")[0];
+  }
+  pos += chunk.size();
 }
 
+CommOut StreamCommitter::finish()
+{
+  Comm cm = scm.getKCMode() == KCMode::None ? Comm::withoutKC(c) : Comm(c, kc);
+  return scm.blind(std::make_shared<const Ins>(), cm);
+}
+
+CommOut CommScheme::commitStream(std::istream &in, size_t n, size_t chunkSize)
+{
+  if (chunkSize == 0) {
+    chunkSize = n;
+  }
+  StreamCommitter sc(*this);
+  Ins chunk;
+  chunk.reserve(std::min(n, chunkSize));
+  while (sc.size() < n) {
+    chunk.resize(std::min(chunkSize, n - sc.size()));
+    for (auto &x : chunk) {
+      if (!(in >> x)) {
+        throw runtime_error("Streamed vector shorter than announced.");
+      }
+    }
+    sc.push(chunk);
+  }
+  return sc.finish();
+}
+
+uint64_t CommCache::digest(const Ins &v)
+{
+  uint64_t h = 0xcbf29ce484222325ULL ^ v.size();
+  for (auto &x : v) {
+    auto b = x.as_bigint();
+    for (size_t i = 0; i < In::num_limbs; i++) {
+      h ^= uint64_t(b.data[i]);
+      h *= 0x100000001b3ULL;
+      h ^= h >> 29;
+    }
+  }
+  return h;
+}
+
+bool CommCache::lookup(uint64_t keyId, uint64_t dig, const Ins &v, CommOut &out)
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  auto it = index.find(Key{keyId, dig});
+  if (it == index.end() || it->second->second.vals() != v) { // digest collisions miss
+    counters.misses++;
+    return false;
+  }
+  lru.splice(lru.begin(), lru, it->second);
+  counters.hits++;
+  out = it->second->second;
+  return true;
+}
+
+void CommCache::insert(uint64_t keyId, uint64_t dig, const CommOut &out)
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  const size_t len = out.vals().size();
+  if (maxEntries == 0 || len > maxElems) {
+    return;
+  }
+  Key k{keyId, dig};
+  auto it = index.find(k);
+  if (it != index.end()) {
+    elems -= it->second->second.vals().size();
+    index.erase(it->second->first);
+    lru.erase(it->second);
+  }
+  while (!lru.empty() && (lru.size() >= maxEntries || elems + len > maxElems)) {
+    elems -= lru.back().second.vals().size();
+    index.erase(lru.back().first);
+    lru.pop_back();
+    counters.evictions++;
+  }
+  lru.emplace_front(k, out);
+  index[k] = lru.begin();
+  elems += len;
+}
+
+CommCache::Stats CommCache::stats() const
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  return counters;
+}
+
+size_t CommCache::size() const
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  return lru.size();
+}
+
+size_t CommCache::elements() const
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  return elems;
+}
+
+void CommCache::clear()
+{
+  std::lock_guard<std::mutex> lk(mtx);
+  lru.clear();
+  index.clear();
+  elems = 0;
+  counters = Stats();
+}
+
+std::shared_ptr<CommCache> CommCache::fromEnv()
+{
+  static std::shared_ptr<CommCache> shared = []() -> std::shared_ptr<CommCache> {
+    const char *s = getenv("LEGO_COMMIT_CACHE");
+    size_t entries = s ? std::stoul(s) : 0;
+    const char *e = getenv("LEGO_COMMIT_CACHE_ELEMS");
+    size_t maxElems = e ? std::stoul(e) : DEFAULT_MAX_ELEMS;
+    return entries ? std::make_shared<CommCache>(entries, maxElems) : nullptr;
+  }();
+  return shared;
+}
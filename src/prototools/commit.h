@@ -4,8 +4,18 @@
 #include "globl.h"
 #include "util.h"
 #include "benchmark.h"
+#include "keyfile.h"
+#include "prf.h"
 
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <istream>
 using std::vector;
 
 using KCT = LG2; // Knowledge Curve
@@ -17,37 +27,138 @@ class Comm;
 using Comms = vector<Comm>;
 using In = LFr;
 using Ins = vector<LFr>;
+using InsPtr = std::shared_ptr<const Ins>;
 
 
 /* == Commitment-related classes == */
 
+/* How a commitment scheme computes the knowledge component kc (a G2 multiexp, about 3x the G1 one):
+ * Eager at commit time, Lazy on first use by a verifier, None for G1-only pipelines (kc cannot be read). */
+enum class KCMode { Eager, Lazy, None };
+
+// a knowledge component computed on first use, shared by the copies of a commitment
+class DeferredKC
+{
+public:
+  explicit DeferredKC(std::function<KCT()> _fn) : fn(_fn) { }
+
+  const KCT &get() {
+    std::call_once(once, [this]() {
+      val = fn();
+      fn = nullptr;
+    });
+    return val;
+  }
+
+private:
+  std::once_flag once;
+  std::function<KCT()> fn;
+  KCT val;
+};
+
 // TODO: This should be an abstract class
 class Comm
 {
 public:
-  // Actual commitment and its knowledge counterpart
+  // Actual commitment; its knowledge counterpart is read with getKC()
   LG1 c;
-  KCT kc;
 
   Comm() : Comm(LG1::zero(), KCT::zero()) { }
   Comm(LG1 _c, KCT _kc) : c(_c), kc(_kc) { }
+  Comm(LG1 _c, std::shared_ptr<DeferredKC> _deferred) : c(_c), kc(KCT::zero()), deferred(_deferred) { }
+
+  static Comm withoutKC(LG1 _c) {
+    Comm cm(_c, KCT::zero());
+    cm.noKC = true;
+    return cm;
+  }
+
+  bool hasKC() const {
+    return !noKC;
+  }
+
+  // the knowledge component, computed now if it was deferred
+  KCT getKC() const {
+    if (noKC) {
+      throw runtime_error("Knowledge component not computed (commitment made in G1-only mode).");
+    }
+    return deferred ? deferred->get() : kc;
+  }
 
   friend Comm operator+(const Comm& a, const Comm& b)  {
-    return Comm(a.c+b.c, a.kc+b.kc);
+    return combine(a.c+b.c, a, b, [](const KCT &x, const KCT &y) { return x+y; });
   }
   friend Comm operator-(const Comm& a, const Comm& b) {
-    return Comm(a.c-b.c, a.kc-b.kc);
+    return combine(a.c-b.c, a, b, [](const KCT &x, const KCT &y) { return x-y; });
   }
 
    Comm operator*(const CommRand b) const {
     auto cOut = b*c;
-    auto kcOut = b*kc;
-    return Comm(cOut, kcOut);
+    return combine(cOut, *this, *this, [b](const KCT &x, const KCT &) { return b*x; });
+  }
+
+  // sum_i coeffs[v][i]*cs[i] for each coefficient vector, sharing the tables of the cs across vectors
+  static Comms linearCombinations(const Comms &cs, const vector<vector<CommRand>> &coeffs) {
+    vector<LG1> c1s;
+    bool anyNoKC = false, anyDeferred = false;
+    for (auto &cm : cs) {
+      c1s.push_back(cm.c);
+      anyNoKC |= cm.noKC;
+      anyDeferred |= bool(cm.deferred);
+    }
+    auto outCs = cpglv::mulManyMulti(coeffs, c1s);
+
+    Comms out;
+    if (anyNoKC) {
+      for (auto &c : outCs) {
+        out.push_back(withoutKC(c));
+      }
+    } else if (anyDeferred) {
+      for (size_t v = 0; v < coeffs.size(); v++) {
+        auto fn = [cs, ks = coeffs[v]]() {
+          vector<KCT> kcs;
+          for (auto &cm : cs) {
+            kcs.push_back(cm.getKC());
+          }
+          return cpglv::mulMany(ks, kcs);
+        };
+        out.push_back(Comm(outCs[v], std::make_shared<DeferredKC>(fn)));
+      }
+    } else {
+      vector<KCT> kcs;
+      for (auto &cm : cs) {
+        kcs.push_back(cm.kc);
+      }
+      auto outKCs = cpglv::mulManyMulti(coeffs, kcs);
+      for (size_t v = 0; v < coeffs.size(); v++) {
+        out.push_back(Comm(outCs[v], outKCs[v]));
+      }
+    }
+    return out;
   }
 
   void set(LG1 _c, KCT _kc) {
     c = _c;
     kc = _kc;
+    deferred.reset();
+    noKC = false;
+  }
+
+private:
+  KCT kc;
+  std::shared_ptr<DeferredKC> deferred;
+  bool noKC = false;
+
+  // commitment cOut whose kc is op(a.kc, b.kc); deferred if either of them is
+  template<typename Op>
+  static Comm combine(const LG1 &cOut, const Comm &a, const Comm &b, Op op) {
+    if (a.noKC || b.noKC) {
+      return withoutKC(cOut);
+    }
+    if (!a.deferred && !b.deferred) {
+      return Comm(cOut, op(a.kc, b.kc));
+    }
+    return Comm(cOut, std::make_shared<DeferredKC>([a, b, op]() { return op(a.getKC(), b.getKC()); }));
   }
 
 };
@@ -60,34 +171,41 @@ struct CommOut {
   Comm c;
   CommRand r;
 
-  Ins xs;
-  int lenXs;
+  // committed values, shared (never modified) by the copies of this CommOut
+  InsPtr xs;
+  int lenXs = 0;
 
   CommOut() {}
 
-  CommOut(const Comm _c, const CommRand _r, const Ins _xs) :
-    c(_c), r(_r), xs(_xs), lenXs(_xs.size())
+  CommOut(const Comm _c, const CommRand _r, Ins _xs) :
+    CommOut(_c, _r, std::make_shared<const Ins>(std::move(_xs)))
   {
 
+  }
+  CommOut(const Comm _c, const CommRand _r, InsPtr _xs) :
+    c(_c), r(_r), xs(_xs), lenXs(_xs->size())
+  {
   }
   CommOut(const Comm _c, const CommRand _r, const In _x)
-  : c(_c), r(_r), xs(vector<In> {_x}), lenXs(1)
+  : CommOut(_c, _r, Ins{_x})
   {
   }
 
+  const Ins &vals() const {
+    static const Ins none;
+    return xs ? *xs : none;
+  }
+
   In val() const {
     if (lenXs != 1) {
       throw runtime_error("val() is only for commitments to single elements.");
     }
-    return xs[0];
+    return (*xs)[0];
   }
 
   CommOut operator*(const CommRand b) const
   {
-      if (lenXs != 1) {
-          throw runtime_error("Operator * on CommOut is only for commitments to single elements.");
-      }
-      return CommOut(c*b, r*b, xs[0]*b);
+      return CommOut(c*b, r*b, val()*b);
   }
 
   friend CommOut operator+(const CommOut& a, const CommOut& b);
@@ -95,35 +213,139 @@ struct CommOut {
 
   static Comms toComms(const CommOuts &outs)
   {
-    auto commFn = [](auto comOut) { return comOut.c;};
+    auto commFn = [](const CommOut &comOut) { return comOut.c;};
 
     return cputil::map<CommOut, Comm>(outs, commFn);
   }
 
   static vector<CommRand> toOpenings(const CommOuts &outs)
   {
-    auto openFn = [](auto comOut) { return comOut.r;};
+    auto openFn = [](const CommOut &comOut) { return comOut.r;};
 
     return cputil::map<CommOut, CommRand>(outs, openFn);
   }
 
-  static vector<Ins> toCommittedVals(const CommOuts &outs)
+  // the committed vectors themselves, not copies
+  static vector<InsPtr> toCommittedVals(const CommOuts &outs)
   {
-    auto commValFn = [](auto comOut) { return comOut.xs;};
+    auto commValFn = [](const CommOut &comOut) { return comOut.xs;};
 
-    return cputil::map<CommOut, Ins>(outs, commValFn);
+    return cputil::map<CommOut, InsPtr>(outs, commValFn);
   }
 };
 
 
+/* Memo of commitments, keyed by a key id (scheme, key and KC mode) and a digest of the committed scalars.
+ * At most maxEntries commitments are kept, the least recently used is evicted first. A hit returns
+ * the first commitment again, randomness included. Shared by schemes and threads. */
+class CommCache
+{
+public:
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+
+  // entries pin their committed vectors: by default at most 2^22 field elements (128 MB) in all
+  static const size_t DEFAULT_MAX_ELEMS = size_t(1) << 22;
+
+  /* At most maxEntries commitments whose vectors hold at most maxElems field elements together
+   * (least recently used ones are evicted first; a vector longer than maxElems is not cached) */
+  explicit CommCache(size_t _maxEntries, size_t _maxElems = DEFAULT_MAX_ELEMS) : maxEntries(_maxEntries), maxElems(_maxElems) { }
+
+  static uint64_t digest(const Ins &v);
+
+  // out = the commitment to v under keyId, if we have it
+  bool lookup(uint64_t keyId, uint64_t dig, const Ins &v, CommOut &out);
+  void insert(uint64_t keyId, uint64_t dig, const CommOut &out);
+
+  Stats stats() const;
+  size_t size() const;
+  // field elements of the cached vectors
+  size_t elements() const;
+  void clear();
+
+  // process-wide cache of LEGO_COMMIT_CACHE entries and LEGO_COMMIT_CACHE_ELEMS elements, nullptr if unset or 0
+  static std::shared_ptr<CommCache> fromEnv();
+
+private:
+  struct Key {
+    uint64_t keyId, dig;
+    bool operator==(const Key &o) const { return keyId == o.keyId && dig == o.dig; }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &k) const { return k.dig ^ (k.keyId * 0x9e3779b97f4a7c15ULL); }
+  };
+  using Entry = std::pair<Key, CommOut>;
+
+  size_t maxEntries;
+  size_t maxElems;
+  size_t elems = 0;
+  std::list<Entry> lru; // most recently used first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+  Stats counters;
+  mutable std::mutex mtx;
+};
+
+// a sparse change to a committed vector: entry idxs[j] grows by deltas[j]
+struct SparseDelta {
+  vector<size_t> idxs;
+  Ins deltas;
+
+  SparseDelta() { }
+  SparseDelta(const vector<size_t> &_idxs, const Ins &_deltas) : idxs(_idxs), deltas(_deltas) {
+    if (idxs.size() != deltas.size()) {
+      throw runtime_error("SparseDelta needs one delta per index.");
+    }
+  }
+
+  void add(size_t i, const In &d) {
+    idxs.push_back(i);
+    deltas.push_back(d);
+  }
+
+  size_t size() const {
+    return idxs.size();
+  }
+};
+
+class CommScheme;
+
+/* Commitment to a vector fed in consecutive chunks (e.g. read from a file): running G1 and G2 multiexps
+ * over the matching slices of the bases, so only the current chunk is held next to the key.
+ * kc is computed as the chunks go by unless the scheme is in KCMode::None (Lazy cannot defer it, the
+ * chunks are gone), and the result does not keep the committed values. */
+class StreamCommitter
+{
+public:
+  explicit StreamCommitter(CommScheme &_scm) : scm(_scm) { }
+
+  // the next chunk.size() entries of the vector
+  void push(const Ins &chunk);
+
+  // entries pushed so far
+  size_t size() const {
+    return pos;
+  }
+
+  CommOut finish();
+
+private:
+  CommScheme &scm;
+  size_t pos = 0;
+  LG1 c = LG1::zero();
+  KCT kc = KCT::zero();
+};
 
 class CommScheme : public Benchmarkable {
+    friend class StreamCommitter;
+
 public:
     long n;
 
-    CommScheme()
+    CommScheme() : cache(CommCache::fromEnv())
     {
-        // Nothing to be done here
     }
 
     virtual void keygen(long _n)
@@ -131,30 +353,237 @@ public:
         n = _n;
 
         // NB: or now no ZK
-        g1s.resize(n);
-        fill(g1s.begin(), g1s.end(), LG1::one());
+        g1s = vector<LG1>(n, LG1::one());
+        g2s = vector<LG2>(n, LG2::one());
+
+        keyReady();
+    }
+
+    /* Independent bases derived from seed on the thread pool: g1s[i] = r_i*g1 and g2s[i] = r_i*g2 with
+     * r_i the i-th field element of the seed's stream (see prf.h), so the same seed gives the same key and
+     * keys can be regenerated instead of stored. The seed is the trapdoor of the key (it gives the
+     * discrete logs of the bases): it has to be kept like the keygen randomness. */
+    void keygenFromSeed(long _n, const cpprf::Seed &seed)
+    {
+        n = _n;
+        auto rs = cpprf::fieldElements<LFr>(seed, 0, n);
+        auto b1s = generatorExps<LG1>(rs);
+        auto b2s = generatorExps<LG2>(rs);
+        normalizeBases(b1s);
+        normalizeBases(b2s);
+        g1s = std::move(b1s);
+        g2s = std::move(b2s);
+
+        keyReady();
+    }
 
-        g2s.resize(n);
-        fill(g2s.begin(), g2s.end(), LG2::one());
+    /* Binary key file (see keyfile.h): loadKey maps the file and commits with the bases in place,
+     * instead of running keygen again. Fixed-base tables are rebuilt if usePrecomputation was set. */
+    virtual void saveKey(const std::string &path) const
+    {
+        cpkeyfile::Writer w(path, cpkeyfile::Kind::CommKey);
+        w.array<LG1>(g1s);
+        w.array<LG2>(g2s);
+        w.close();
+    }
+
+    virtual void loadKey(const std::string &path)
+    {
+        cpkeyfile::Reader r(path, cpkeyfile::Kind::CommKey);
+        g1s = r.array<LG1>();
+        g2s = r.array<LG2>();
+        n = g1s.size();
+        keyReady();
+    }
+
+    /* Build fixed-base tables at the end of keygen (window 0: cpmexp::fixedBaseWindow picks it from n).
+     * They hold ceil(254/window) affine points per base in both G1 and G2, that much larger than the key:
+     * about 30x for 2^6 bases, 20x at 2^14 and 16x from 2^18 with the default window. */
+    void usePrecomputation(size_t window = 0)
+    {
+        precompOn = true;
+        precompWindow = window;
+    }
+
+    // Fixed-base tables for the current bases: about 254/window points per base and group
+    void precompute(size_t window = 0)
+    {
+        g1Tbl = mkFixedBaseTable<LG1>(commitBases1(), window);
+        g2Tbl = mkFixedBaseTable<LG2>(commitBases2(), window);
+    }
+
+    bool hasPrecomputation() const {
+        return !g1Tbl.empty();
+    }
+
+    // Lazy commitments compute kc through this scheme, which must outlive them
+    void setKCMode(KCMode m) {
+        kcMode = m;
+    }
+
+    KCMode getKCMode() const {
+        return kcMode;
     }
 
     LG1 getBlindingH() const {
         return LG1::one(); // XXX: Should actually be computed at kg time
     }
 
-    vector<LG1> getBases1() const {
-      return g1s;
+    // views of the bases (no copy), valid until the next keygen
+    cputil::Span<LG1> getBases1() const {
+      return g1s.view();
+    }
+    cputil::Span<LG2> getBases2() const {
+      return g2s.view();
+    }
+
+    // Commitments go through c (nullptr: no memo); the default comes from LEGO_COMMIT_CACHE.
+    // The cache keeps the committed vectors alive, up to its element bound (see CommCache).
+    void setCache(std::shared_ptr<CommCache> c) {
+        cache = c;
+    }
+
+    std::shared_ptr<CommCache> getCache() const {
+        return cache;
     }
 
     virtual CommOut commit(const Ins &v) {
         assert(g1s.size() != 0);
-        //auto r = CommRand::random_element(); // XXX: Ignored
-        CommRand r = CommRand::zero();
+        return cachedCommit(v, [this, &v]() { return commitOnce(std::make_shared<const Ins>(v)); });
+    }
 
-        LG1 c = multiExpMA<LG1>(g1s, v) + r*getBlindingH();
-        LG2 kc = multiExpMA<LG2>(g2s, v);
+    // commitment whose committed values are v itself (no copy), e.g. commitShared(make_shared<const Ins>(move(w)))
+    CommOut commitShared(InsPtr v) {
+        return cachedCommit(*v, [this, v]() { return commitOnce(v); });
+    }
 
-        return CommOut(Comm(c, kc), r, v);
+    // Commitments to several vectors on the same key; the bases are read once for all of them
+    CommOuts commitMany(const vector<const Ins *> &vs) {
+        return cachedCommits(vs, [this](const vector<const Ins *> &missing) { return commitManyUncached(missing); });
+    }
+
+    /* Commitments to independent vectors run concurrently on the thread pool: one task per vector and
+     * group, each multiexp cut in about numThreads/tasks chunks, so that mid-sized vectors fill the cores */
+    CommOuts commitBatch(const vector<const Ins *> &vs) {
+        return cachedCommits(vs, [this](const vector<const Ins *> &missing) { return commitBatchUncached(missing); });
+    }
+
+    CommOuts commitBatch(const vector<Ins> &vs) {
+        vector<const Ins *> ptrs;
+        for (auto &v : vs) {
+            ptrs.push_back(&v);
+        }
+        return commitBatch(ptrs);
+    }
+
+    CommOuts commitManyUncached(const vector<const Ins *> &vs) {
+        startBenchmark("commit_many");
+        if (hasPrecomputation() || kcMode != KCMode::Eager) {
+            CommOuts outs;
+            for (auto v : vs) {
+                outs.push_back(commitOnce(std::make_shared<const Ins>(*v)));
+            }
+            stopBenchmark("commit_many");
+            return outs;
+        }
+
+        auto cs = multiExpMulti<LG1>(commitBases1(), vs, "commitMany.c");
+        auto kcs = multiExpMulti<LG2>(commitBases2(), vs, "commitMany.kc");
+        CommOuts outs;
+        for (auto i = 0; i < vs.size(); i++) {
+            outs.push_back(blind(std::make_shared<const Ins>(*vs[i]), Comm(cs[i], kcs[i])));
+        }
+        stopBenchmark("commit_many");
+        return outs;
+    }
+
+    CommOuts commitBatchUncached(const vector<const Ins *> &vs) {
+        startBenchmark("commit_batch");
+        const size_t k = vs.size();
+        const bool eagerKC = kcMode == KCMode::Eager;
+        const size_t nTasks = eagerKC ? 2*k : k;
+        const size_t chunks = std::max<size_t>(1, (cppool::numThreads() + nTasks - 1) / std::max<size_t>(1, nTasks));
+
+        vector<LG1> cs(k);
+        vector<KCT> kcs(k);
+        cppool::parallelFor(nTasks, [&](size_t t) {
+            if (t < k) {
+                cs[t] = commitExp1(*vs[t], chunks);
+            } else {
+                kcs[t-k] = commitExp2(*vs[t-k], chunks);
+            }
+        });
+
+        CommOuts outs;
+        for (size_t i = 0; i < k; i++) { // blinding samples randomness: kept on this thread
+            auto v = std::make_shared<const Ins>(*vs[i]);
+            auto cm = eagerKC ? Comm(cs[i], kcs[i]) : withKC(cs[i], [this, v]() { return commitExp2(*v); });
+            outs.push_back(blind(v, cm));
+        }
+        stopBenchmark("commit_batch");
+        return outs;
+    }
+
+    CommOuts commitMany(const vector<Ins> &vs) {
+        vector<const Ins *> ptrs;
+        for (auto &v : vs) {
+            ptrs.push_back(&v);
+        }
+        return commitMany(ptrs);
+    }
+
+    /* The commitment to old.xs + delta, from old and the k changed entries alone (k-term multiexps):
+     * commitments are linear in the committed vector, and the opening old.r carries over.
+     * The group work is O(k), but the committed values are copied (n field elements, no group
+     * operations) since old.xs may be shared with other commitments. */
+    CommOut update(const CommOut &old, const SparseDelta &delta) {
+        auto bases1 = commitBases1();
+        auto bases2 = commitBases2();
+        CommOut out = old;
+        if (delta.size() == 0) {
+            return out;
+        }
+        auto xs = std::make_shared<Ins>(old.vals()); // old.xs may be shared
+        vector<LG1> b1s;
+        vector<LG2> b2s;
+        for (size_t j = 0; j < delta.size(); j++) {
+            auto i = delta.idxs[j];
+            if (i >= xs->size() || i >= bases1.size()) {
+                throw runtime_error("Sparse delta index out of range of the commitment.");
+            }
+            (*xs)[i] = (*xs)[i] + delta.deltas[j];
+            b1s.push_back(bases1[i]);
+            b2s.push_back(bases2[i]);
+        }
+        out.xs = xs;
+
+        LG1 c = multiExpMA<LG1>(b1s, delta.deltas, "update.c");
+        out.c = old.c + withKC(c, [b2s = std::move(b2s), deltas = delta.deltas]() { return multiExpMA<LG2>(b2s, deltas, "update.kc"); });
+        return out;
+    }
+
+    // streamed commitments: push chunks into the committer, or read n scalars from in, chunkSize at a time
+    // (chunkSize 0: all in one chunk)
+    StreamCommitter commitStream() {
+        return StreamCommitter(*this);
+    }
+
+    CommOut commitStream(std::istream &in, size_t n, size_t chunkSize);
+
+    template<typename It>
+    CommOut commitStream(It begin, It end, size_t chunkSize) {
+        StreamCommitter sc(*this);
+        Ins chunk;
+        chunk.reserve(chunkSize);
+        for (auto it = begin; it != end; ++it) {
+            chunk.push_back(*it);
+            if (chunk.size() == chunkSize) {
+                sc.push(chunk);
+                chunk.clear();
+            }
+        }
+        sc.push(chunk);
+        return sc.finish();
     }
 
     virtual CommOut commit(const In &v) {
@@ -167,9 +596,123 @@ public:
 
 
 protected:
-    vector<LG1> g1s;
-    vector<LG2> g2s;
+    cpkeyfile::Array<LG1> g1s;
+    cpkeyfile::Array<LG2> g2s;
+
+    uint64_t keyId = 0;
+    std::shared_ptr<CommCache> cache;
+
+    bool precompOn = false;
+    size_t precompWindow = 0;
+    KCMode kcMode = KCMode::Eager;
+    cpmexp::FixedBaseTable<LG1> g1Tbl;
+    cpmexp::FixedBaseTable<LG2> g2Tbl;
+
+    // bases commitments are computed on
+    virtual cputil::Span<LG1> commitBases1() const { return g1s.view(); }
+    virtual cputil::Span<LG2> commitBases2() const { return g2s.view(); }
+
+    // a new key is in place (from keygen or loadKey): new cache id and fixed-base tables
+    void keyReady() {
+        newKeyId();
+        g1Tbl = cpmexp::FixedBaseTable<LG1>();
+        g2Tbl = cpmexp::FixedBaseTable<LG2>();
+        if (precompOn) {
+            precompute(precompWindow);
+        }
+    }
+
+    // a fresh id for the key just generated
+    void newKeyId() {
+        static std::atomic<uint64_t> nextId(1);
+        keyId = nextId++;
+    }
+
+    // cache key: commitments differ per key and per KC mode
+    uint64_t cacheKeyId() const {
+        return (keyId << 2) | uint64_t(kcMode);
+    }
 
+    // fn(missing) are the commitments to the vectors of vs not in the cache
+    CommOuts cachedCommits(const vector<const Ins *> &vs, const std::function<CommOuts(const vector<const Ins *> &)> &fn) {
+        if (!cache) {
+            return fn(vs);
+        }
+        CommOuts outs(vs.size());
+        vector<uint64_t> digs(vs.size());
+        vector<const Ins *> missing;
+        vector<size_t> missingAt;
+        for (size_t i = 0; i < vs.size(); i++) {
+            digs[i] = CommCache::digest(*vs[i]);
+            if (!cache->lookup(cacheKeyId(), digs[i], *vs[i], outs[i])) {
+                missing.push_back(vs[i]);
+                missingAt.push_back(i);
+            }
+        }
+        auto fresh = fn(missing);
+        for (size_t j = 0; j < fresh.size(); j++) {
+            outs[missingAt[j]] = fresh[j];
+            cache->insert(cacheKeyId(), digs[missingAt[j]], fresh[j]);
+        }
+        return outs;
+    }
+
+    // fn() is the commitment to v, looked up in the cache first
+    CommOut cachedCommit(const Ins &v, const std::function<CommOut()> &fn) {
+        if (!cache) {
+            return fn();
+        }
+        auto dig = CommCache::digest(v);
+        CommOut out;
+        if (cache->lookup(cacheKeyId(), dig, v, out)) {
+            return out;
+        }
+        out = fn();
+        cache->insert(cacheKeyId(), dig, out);
+        return out;
+    }
+
+    // adds the randomness to the unblinded commitment cm of v
+    virtual CommOut blind(InsPtr v, const Comm &cm) {
+        //auto r = CommRand::random_element(); // XXX: Ignored
+        CommRand r = CommRand::zero();
+        return CommOut(cm + Comm(r*getBlindingH(), KCT::zero()), r, v);
+    }
+
+    // blinded commitment of v; v is also what a lazy kc reads and what the result holds
+    CommOut commitOnce(InsPtr v) {
+        return blind(v, commitExps(v));
+    }
+
+    // unblinded commitment of v, with kc as the KC mode says
+    Comm commitExps(InsPtr v) const {
+        return withKC(commitExp1(*v), [this, v]() { return commitExp2(*v); });
+    }
+
+    // commitment c with the kc computed by kcFn as the KC mode says
+    Comm withKC(const LG1 &c, std::function<KCT()> kcFn) const {
+        switch (kcMode) {
+            case KCMode::Lazy:
+                return Comm(c, std::make_shared<DeferredKC>(kcFn));
+            case KCMode::None:
+                return Comm::withoutKC(c);
+            case KCMode::Eager:
+            default:
+                return Comm(c, kcFn());
+        }
+    }
+
+    // multiexps of a commitment, through the fixed-base tables if we have them (chunks 0: one per thread)
+    LG1 commitExp1(const Ins &v, size_t chunks = 0) const {
+        return g1Tbl.empty() ?
+            multiExpMA<LG1>(commitBases1(), v, "commit.c", cpmexp::Method::Auto, chunks) :
+            multiExpFixedBase<LG1>(g1Tbl, v, "commit.c", chunks);
+    }
+    LG2 commitExp2(const Ins &v, size_t chunks = 0) const {
+        return g2Tbl.empty() ?
+            multiExpMA<LG2>(commitBases2(), v, "commit.kc", cpmexp::Method::Auto, chunks) :
+            multiExpFixedBase<LG2>(g2Tbl, v, "commit.kc", chunks);
+    }
 
 };
 
@@ -1 +1,288 @@
 #include "interp.h"
+
+#include <map>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace cpdomain {
+
+  namespace {
+    std::mutex cacheMutex;
+    std::map<size_t, std::shared_ptr<const Domain>> cache;
+
+    void scale(IScalars &a, const IScalars &by)
+    {
+      cppool::parallelFor(a.size(), [&](size_t i) { a[i] *= by[i]; }, cppool::FINE_GRAIN);
+    }
+
+    Method &config()
+    {
+      static Method cfg = []() {
+        const char *m = getenv("LEGO_FFT_METHOD");
+        if (!m || std::string(m) == "auto") {
+          return Method::Auto;
+        } else if (std::string(m) == "radix2") {
+          return Method::Radix2;
+        } else if (std::string(m) == "four_step") {
+          return Method::FourStep;
+        }
+        throw std::invalid_argument("Unknown LEGO_FFT_METHOD " + std::string(m));
+      }();
+      return cfg;
+    }
+
+    // a (n x n) transposed in place, swapping tiles above the diagonal with those below
+    void transposeSquare(IScalar *a, size_t n)
+    {
+      const size_t TILE = 16;
+      const size_t tiles = (n + TILE - 1)/TILE;
+      cppool::parallelFor(tiles, [&](size_t t) {
+        const size_t r0 = t*TILE, r1 = std::min(n, r0 + TILE);
+        for (size_t c0 = r0; c0 < n; c0 += TILE) {
+          const size_t c1 = std::min(n, c0 + TILE);
+          for (size_t r = r0; r < r1; r++) {
+            for (size_t c = std::max(c0, r + 1); c < c1; c++) {
+              std::swap(a[r*n + c], a[c*n + r]);
+            }
+          }
+        }
+      });
+    }
+
+    // the len-element blocks of a rearranged in place: block d gets the old block from(d), one cycle at a time
+    template<typename F>
+    void permuteBlocks(IScalar *a, size_t nBlocks, size_t len, F from)
+    {
+      std::vector<bool> done(nBlocks, false);
+      IScalars tmp(len);
+      for (size_t s = 0; s < nBlocks; s++) {
+        if (done[s]) {
+          continue;
+        }
+        std::copy(a + s*len, a + (s+1)*len, tmp.begin());
+        size_t d = s;
+        for (size_t b = from(d); b != s; d = b, b = from(d)) {
+          std::copy(a + b*len, a + (b+1)*len, a + d*len);
+          done[d] = true;
+        }
+        std::copy(tmp.begin(), tmp.end(), a + d*len);
+        done[d] = true;
+      }
+    }
+
+    /* a (n x 2n) transposed in place into (2n x n): the left and right n x n halves of the rows are
+     * gathered into two contiguous squares, then each square is transposed */
+    void transposeWide(IScalar *a, size_t n)
+    {
+      permuteBlocks(a, 2*n, n, [n](size_t d) { return d < n ? 2*d : 2*(d - n) + 1; });
+      transposeSquare(a, n);
+      transposeSquare(a + n*n, n);
+    }
+
+    // the inverse of transposeWide: a (2n x n) transposed in place into (n x 2n)
+    void transposeTall(IScalar *a, size_t n)
+    {
+      transposeSquare(a, n);
+      transposeSquare(a + n*n, n);
+      permuteBlocks(a, 2*n, n, [n](size_t d) { return (d % 2)*n + d/2; });
+    }
+
+    IScalars powers(const IScalar &x, const IScalar &first, size_t k)
+    {
+      IScalars ps(k);
+      IScalar p = first;
+      for (size_t i = 0; i < k; i++) {
+        ps[i] = p;
+        p *= x;
+      }
+      return ps;
+    }
+  }
+
+  void forceMethod(Method m)
+  {
+    config() = m;
+  }
+
+  Method method()
+  {
+    return config();
+  }
+
+  const char *methodName(Method m)
+  {
+    switch (m) {
+      case Method::Auto: return "auto";
+      case Method::Radix2: return "radix2";
+      case Method::FourStep: return "four_step";
+    }
+    return "unknown";
+  }
+
+  Domain::Domain(size_t n) : base(get_evaluation_domain<IScalar>(n)), m(base->m)
+  {
+    radix2 = dynamic_cast<const basic_radix2_domain<IScalar> *>(base.get()) != nullptr;
+    if (!radix2) {
+      return;
+    }
+    while ((size_t(1) << logm) < m) {
+      logm++;
+    }
+    const IScalar omega = base->get_domain_element(1);
+    const IScalar g = IScalar::multiplicative_generator;
+    mInv = IScalar(long(m)).inverse();
+    twiddles = powers(omega, IScalar::one(), m/2);
+    invTwiddles = powers(omega.inverse(), IScalar::one(), m/2);
+    cosetPows = powers(g, IScalar::one(), m);
+    icosetScale = powers(g.inverse(), mInv, m);
+    ZinvOnCoset = base->compute_vanishing_polynomial(g).inverse();
+  }
+
+  // iterative radix-2: bit-reversal, then log len rounds of butterflies
+  void Domain::radix2FFT(IScalar *a, size_t len, const IScalars &tw) const
+  {
+    for (size_t i = 0, j = 0; i < len; i++) {
+      if (i < j) {
+        std::swap(a[i], a[j]);
+      }
+      size_t bit = len >> 1;
+      for (; j & bit; bit >>= 1) {
+        j ^= bit;
+      }
+      j |= bit;
+    }
+    for (size_t blk = 2; blk <= len; blk <<= 1) {
+      const size_t half = blk/2;
+      const size_t step = m/blk; // tw[j*step] = omega_blk^j
+      for (size_t s = 0; s < len; s += blk) {
+        for (size_t j = 0; j < half; j++) {
+          const IScalar t = tw[j*step]*a[s+j+half];
+          a[s+j+half] = a[s+j] - t;
+          a[s+j] += t;
+        }
+      }
+    }
+  }
+
+  /* m = n1*n2, input index j1*n2 + j2, output index k1 + n1*k2:
+   *   X[k1 + n1*k2] = sum_j2 omega_n2^(j2*k2) * omega^(j2*k1) * sum_j1 omega_n1^(j1*k1) * x[j1*n2 + j2]
+   * i.e. n2 FFTs of length n1 (the columns), twiddle scaling, n1 FFTs of length n2 (the rows) and
+   * transposes, so that each FFT runs on contiguous memory. For even log m the matrix is square; for
+   * odd log m, n2 = 2*n1 and it is transposed as two squares. Either way in place: no m-sized buffer. */
+  void Domain::fourStep(IScalars &a, const IScalars &tw) const
+  {
+    const size_t n1 = size_t(1) << (logm/2);
+    const size_t n2 = m/n1;
+    // omega^e (or omega^-e) for e < m from the half table: omega^(m/2) = -1
+    auto power = [&](size_t e) { return e < m/2 ? tw[e] : -tw[e - m/2]; };
+    auto columnFFTs = [&](IScalar *cols) { // cols[j2*n1 + j1]
+      cppool::parallelFor(n2, [&](size_t j2) {
+        IScalar *col = cols + j2*n1;
+        radix2FFT(col, n1, tw);
+        for (size_t k1 = 1; k1 < n1; k1++) {
+          col[k1] *= power(j2*k1);
+        }
+      });
+    };
+    auto rowFFTs = [&](IScalar *rows) { // rows[k1*n2 + j2]
+      cppool::parallelFor(n1, [&](size_t k1) {
+        radix2FFT(rows + k1*n2, n2, tw);
+      });
+    };
+
+    if (n1 == n2) {
+      transposeSquare(a.data(), n1);
+      columnFFTs(a.data());
+      transposeSquare(a.data(), n1);
+      rowFFTs(a.data());
+      transposeSquare(a.data(), n1);
+      return;
+    }
+    transposeWide(a.data(), n1); // a[j2*n1 + j1]
+    columnFFTs(a.data());
+    transposeTall(a.data(), n1); // a[k1*n2 + j2]
+    rowFFTs(a.data());
+    transposeWide(a.data(), n1); // a[k2*n1 + k1]
+  }
+
+  void Domain::transform(IScalars &a, const IScalars &tw) const
+  {
+    assert(a.size() == m);
+    const Method meth = config();
+    if (meth == Method::FourStep || (meth == Method::Auto && m >= FOUR_STEP_MIN)) {
+      fourStep(a, tw);
+    } else {
+      radix2FFT(a.data(), m, tw);
+    }
+  }
+
+  void Domain::FFT(IScalars &a) const
+  {
+    if (!radix2) {
+      base->FFT(a);
+      return;
+    }
+    transform(a, twiddles);
+  }
+
+  void Domain::iFFT(IScalars &a) const
+  {
+    if (!radix2) {
+      base->iFFT(a);
+      return;
+    }
+    transform(a, invTwiddles);
+    cppool::parallelFor(m, [&](size_t i) { a[i] *= mInv; }, cppool::FINE_GRAIN);
+  }
+
+  void Domain::cosetFFT(IScalars &a) const
+  {
+    if (!radix2) {
+      base->cosetFFT(a, IScalar::multiplicative_generator);
+      return;
+    }
+    scale(a, cosetPows);
+    transform(a, twiddles);
+  }
+
+  void Domain::icosetFFT(IScalars &a) const
+  {
+    if (!radix2) {
+      base->icosetFFT(a, IScalar::multiplicative_generator);
+      return;
+    }
+    transform(a, invTwiddles);
+    scale(a, icosetScale);
+  }
+
+  void Domain::divideByZOnCoset(IScalars &a) const
+  {
+    if (!radix2) {
+      base->divide_by_Z_on_coset(a);
+      return;
+    }
+    cppool::parallelFor(m, [&](size_t i) { a[i] *= ZinvOnCoset; }, cppool::FINE_GRAIN);
+  }
+
+  std::shared_ptr<const Domain> get(size_t n)
+  {
+    {
+      std::lock_guard<std::mutex> lock(cacheMutex);
+      auto it = cache.find(n);
+      if (it != cache.end()) {
+        return it->second;
+      }
+    }
+    auto d = std::make_shared<const Domain>(n); // built outside the lock; a concurrent duplicate is dropped
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cache.emplace(n, d).first->second;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+  }
+
+} // end namespace cpdomain
@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
 using std::vector;
 using std::shared_ptr;
 
@@ -18,54 +19,105 @@ using IPoly = vector<IScalar>;
 
 using domain_ptr = std::shared_ptr<evaluation_domain<IScalar> >;
 
+/* Process-wide cache of evaluation domains with their precomputed tables, one per requested size:
+ * provers asking for the same n again skip domain setup altogether. On radix-2 domains (the
+ * multiplicative subgroup of size m) the FFTs run on cached twiddles and the coset shifts
+ * multiply by cached powers of the coset generator; other domains go to libfqfft.
+ * Tables take about 3m field elements per size; clear() drops them.
+ * Large radix-2 transforms use the four-step algorithm: the vector is seen as a sqrt(m) x sqrt(m)
+ * matrix, whose row FFTs fit in cache and run on the thread pool, with tiled transposes in between
+ * (in place, also for odd log m where the matrix is sqrt(m/2) x sqrt(2m)). */
+namespace cpdomain {
+
+  enum class Method {
+    Auto,     // four-step from FOUR_STEP_MIN points
+    Radix2,   // iterative radix-2 over the whole vector, single-threaded
+    FourStep
+  };
+
+  const size_t FOUR_STEP_MIN = size_t(1) << 14;
+
+  // overrides the choice for radix-2 domains (also set by LEGO_FFT_METHOD=auto|radix2|four_step)
+  void forceMethod(Method m);
+  Method method();
+  const char *methodName(Method m);
+
+  class Domain {
+  public:
+    explicit Domain(size_t n);
+
+    const domain_ptr base; // the libfqfft domain (Lagrange evaluations, Z, ...)
+    const size_t m;
+
+    void FFT(IScalars &a) const;
+    void iFFT(IScalars &a) const;
+    // on the coset g*<omega>, g = IScalar::multiplicative_generator
+    void cosetFFT(IScalars &a) const;
+    void icosetFFT(IScalars &a) const;
+    void divideByZOnCoset(IScalars &a) const;
+    void addPolyZ(const IScalar &coeff, IScalars &H) const { base->add_poly_Z(coeff, H); }
+
+    bool isRadix2() const { return radix2; }
+    // 1/Z on the coset, where Z is constant (radix-2 domains only)
+    IScalar zInvOnCoset() const { return ZinvOnCoset; }
+
+  private:
+    bool radix2;
+    size_t logm = 0;
+    IScalars twiddles;     // omega^i, i < m/2
+    IScalars invTwiddles;  // omega^-i, i < m/2
+    IScalars cosetPows;    // g^i, i < m
+    IScalars icosetScale;  // g^-i/m, i < m (inverse FFT scaling folded in)
+    IScalar mInv;
+    IScalar ZinvOnCoset;   // Z is g^m-1 on the whole coset
+
+    // a radix-2 transform: tw are the twiddles or the inverse ones
+    void transform(IScalars &a, const IScalars &tw) const;
+    // in place on a[0..len), len | m, with the root of unity of order len taken from tw
+    void radix2FFT(IScalar *a, size_t len, const IScalars &tw) const;
+    void fourStep(IScalars &a, const IScalars &tw) const;
+  };
+
+  // the cached domain for size n (built on first request)
+  std::shared_ptr<const Domain> get(size_t n);
+
+  void clear();
+
+} // end namespace cpdomain
+
 class Interpolator {
 	public:
 	domain_ptr domain;
 	long n;
 	const size_t fldBitSz;
 
-	
+	// window tables of g1/g2 are built on first use, so a group no key needs costs nothing
 	size_t g1_exp_count;
-	size_t g1_window;
-	window_table<LG1> g1_table;
-
 	size_t g2_exp_count;
-	size_t g2_window;
-	window_table<LG2> g2_table;
-	
-	template<typename T>
-	void setupExp(
-		const long n,
-		size_t &g_exp_count,
-		size_t &g_window,
-		window_table<T> &g_table)
-	{
-		// setup multiexp
-		g_exp_count = n;
-		g_window = get_exp_window_size<T>(g_exp_count);
-		g_table = get_window_table(fldBitSz, g_window, T::one());
-	}
 	
+	const window_table<LG1> &g1Table() { return table<LG1>(g1_once, g1_exp_count, g1_window, g1_table); }
+	const window_table<LG2> &g2Table() { return table<LG2>(g2_once, g2_exp_count, g2_window, g2_table); }
+
 	vector<LG1> mkG1Exp(const IScalars &xs)
 	{	
 		assert(xs.size() <= n);
-		return batch_exp(fldBitSz, g1_window, g1_table, xs);
+		auto &tbl = g1Table();
+		return batchExp(fldBitSz, g1_window, tbl, xs);
 	}
 
 	vector<LG2> mkG2Exp(const IScalars &xs)
 	{	
 		assert(xs.size() <= n);
-		return batch_exp(fldBitSz, g2_window, g2_table, xs);
+		auto &tbl = g2Table();
+		return batchExp(fldBitSz, g2_window, tbl, xs);
 	}
 	
-	Interpolator(long _n, long N) : n(_n), fldBitSz(LFr::size_in_bits()) {
-		domain = get_evaluation_domain<IScalar>(n);
-		setupExp<LG1>(N, g1_exp_count, g1_window, g1_table);
-		setupExp<LG2>(N, g2_exp_count, g2_window, g2_table);
+	Interpolator(long _n, long N) : n(_n), fldBitSz(LFr::size_in_bits()), g1_exp_count(N), g2_exp_count(N) {
+		domain = cpdomain::get(n)->base;
 	}
 	Interpolator(long _n) : Interpolator(_n, _n) {}
 	
-IScalars getAllLagrangianPolys(const IScalar tgtPt) {
+	IScalars getAllLagrangianPolys(const IScalar tgtPt) {
 		auto lagrangianPolysOnTgt = domain->evaluate_all_lagrange_polynomials(tgtPt);
 		return lagrangianPolysOnTgt;
 	}
@@ -77,6 +129,25 @@ IScalars getAllLagrangianPolys(const IScalar tgtPt) {
 		return Zt;
 	}
 
+	private:
+	size_t g1_window = 0;
+	window_table<LG1> g1_table;
+	std::once_flag g1_once;
+
+	size_t g2_window = 0;
+	window_table<LG2> g2_table;
+	std::once_flag g2_once;
+
+	// setup multiexp (once, also when first used from several threads)
+	template<typename T>
+	const window_table<T> &table(std::once_flag &once, size_t g_exp_count, size_t &g_window, window_table<T> &g_table)
+	{
+		std::call_once(once, [&]() {
+			g_window = get_exp_window_size<T>(g_exp_count);
+			g_table = mkWindowTable(fldBitSz, g_window, T::one());
+		});
+		return g_table;
+	}
 };
 
 
@@ -47,10 +47,10 @@ public:
     }
     swap(beta_suff_rho_cur, beta_suff_rho_old);
     uint64 pBound = 1 << (d-j-2);
-    for (uint64 p = 0; p < pBound; p++) {
+    cppool::parallelFor(pBound, [&](uint64 p) {
       auto old_p = pBound + p; // 1 concat p
       beta_suff_rho_cur[p] = beta_suff_rho_old[old_p]*rhoInvs[j+1];
-    }
+    }, cppool::FINE_GRAIN);
     cur_suff_j++;
 
   }
@@ -96,10 +96,10 @@ public:
     dst[1] = eqbit(true, r[0]);
 
     for (auto j = 1; j < d; j++) {
-      for (uint64 p = 0; p < 1 << (j+1); p++) {
+      cppool::parallelFor(1 << (j+1), [&](uint64 p) {
         bool msb = (p >= (1 << j)); // most significant bit of p
         tmp[p] = eqbit(msb, r[j])*dst[p >> 1];
-      }
+      }, cppool::FINE_GRAIN);
       swap(tmp, dst);
     }
   }
@@ -174,7 +174,7 @@ protected:
   uint64 n;
 
   Ins curVTable, oldVTable;
-  Ins v; // v contains the "original" vector of points we are doing mle on
+  InsPtr v; // v contains the "original" vector of points we are doing mle on (shared, e.g. with a CommOut)
   // NB: v is not the whole matrix in the matrix version of DPMle but a processed variant
 
 public:
@@ -182,18 +182,20 @@ public:
   {
     oldVTable.resize(1 << d);
     curVTable.resize(1 << d);
-    v.resize(1 << d);
     fill(curVTable.begin(), curVTable.end(), In::zero());
-    fill(v.begin(), v.end(), In::zero());
   }
 
-  DPMle(size_t _d, uint64 _n, const Ins &_v) : d(_d), n(_n), curVTable(_v), v(_v)
+  DPMle(size_t _d, uint64 _n, InsPtr _v) : d(_d), n(_n), curVTable(*_v), v(_v)
   {
     oldVTable.resize(1 << d);
   }
 
-  const Ins getV() const {
-    return v;
+  DPMle(size_t _d, uint64 _n, const Ins &_v) : DPMle(_d, _n, std::make_shared<const Ins>(_v))
+  {
+  }
+
+  const Ins &getV() const {
+    return *v;
   }
 
   void pushRandomness(In r, size_t j) {
@@ -201,12 +203,12 @@ public:
     swap(curVTable, oldVTable);
     // int64 pStart = 1 << (j+1);
     uint64 pBound = 1 << (d-j-1);
-    for (uint64 p = 0; p < pBound; p++ ) {
+    cppool::parallelFor(pBound, [&](uint64 p) {
       auto p0 = p; // 0 concat p
       auto p1 = p0 + pBound; // 1 concat p
       curVTable[p] = oldVTable[p0]*eqbit(false, r) +
                      oldVTable[p1]*eqbit(true, r);
-    }
+    }, cppool::FINE_GRAIN);
   }
 
   In getVTable(size_t j, uint64 p) const {
@@ -249,13 +251,14 @@ public:
 
     // we preprocess the vector scaling every element _A[p]
 
-    for (uint64 r = 0; r < _n; r++) {
+    cppool::parallelFor(_n, [&](uint64 r) {
       for (uint64 l = 0; l < _n; l++) {
         auto p = (l << _d) + r;
         auto inc = _A[p] * eqTbl[l];
-        v[r] = curVTable[r] = curVTable[r] + inc;
+        curVTable[r] = curVTable[r] + inc;
       }
-    }
+    });
+    v = std::make_shared<const Ins>(curVTable);
 
   }
 
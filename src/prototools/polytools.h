@@ -101,28 +101,58 @@ public:
     }
 
 
-    static Comm evalAsPolyOn(const Comms &comms, const PolyTField &pt)
+    // 1, pt, ..., pt^(n-1)
+    static Scalars powersOf(const PolyTField &pt, size_t n)
     {
-        auto rslt = comms[0];
-        auto scaling = pt;
-        for (auto i = 1; i < comms.size(); i++) {
-            rslt = rslt + comms[i]*scaling;
-            scaling = scaling*pt;
+        Scalars pows(n);
+        auto ptPow = PolyTField::one();
+        for (size_t i = 0; i < n; i++) {
+            pows[i] = ptPow;
+            ptPow = ptPow * pt;
         }
-        return rslt;
+        return pows;
     }
 
-    static CommOut evalAsPolyOn(const CommOuts &cmouts, const PolyTField &pt)
+    /* The committed polynomial evaluated at each of pts (e.g. 0, 1 and r in a sumcheck round):
+     * one small multiexp of the coefficient commitments by the powers of each point, with the
+     * tables of the commitments shared by all pts (see Comm::linearCombinations) */
+    static Comms evalAsPolyOn(const Comms &comms, const Scalars &pts)
+    {
+        vector<Scalars> coeffs;
+        for (auto &pt : pts) {
+            coeffs.push_back(powersOf(pt, comms.size()));
+        }
+        return Comm::linearCombinations(comms, coeffs);
+    }
+
+    static CommOuts evalAsPolyOn(const CommOuts &cmouts, const Scalars &pts)
     {
-        auto rslt = cmouts[0];
-        auto scaling = pt;
-        for (auto i = 1; i < cmouts.size(); i++) {
-            rslt = rslt + cmouts[i]*scaling;
-            scaling = scaling*pt;
+        auto evalComms = evalAsPolyOn(CommOut::toComms(cmouts), pts);
+
+        CommOuts rslt;
+        for (size_t p = 0; p < pts.size(); p++) {
+            auto pows = powersOf(pts[p], cmouts.size());
+            auto r = CommRand::zero();
+            auto x = In::zero();
+            for (size_t i = 0; i < cmouts.size(); i++) {
+                r = r + pows[i]*cmouts[i].r;
+                x = x + pows[i]*cmouts[i].val();
+            }
+            rslt.push_back(CommOut(evalComms[p], r, x));
         }
         return rslt;
     }
 
+    static Comm evalAsPolyOn(const Comms &comms, const PolyTField &pt)
+    {
+        return evalAsPolyOn(comms, Scalars{pt})[0];
+    }
+
+    static CommOut evalAsPolyOn(const CommOuts &cmouts, const PolyTField &pt)
+    {
+        return evalAsPolyOn(cmouts, Scalars{pt})[0];
+    }
+
     CommOuts commit(CommScheme *comScm) const
     {
         auto mkComLambda =  [&comScm](auto coeff) {
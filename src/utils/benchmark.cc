@@ -14,6 +14,20 @@ void print_bm(string msgtag, string bmlbl, const Benchmarkable &obj)
   fmt_time(msgtag, t);
 }
 
+void print_mexp_counters(const cpstats::Sites &sites)
+{
+  for (auto &s : sites) {
+    auto &c = s.second;
+    string methods;
+    for (auto &m : c.methods) {
+      methods += fmt::format("{}{}x{}", methods.empty() ? "" : ",", m.second, m.first);
+    }
+    fmt::print(
+      "##mexp-site {}: calls {}, scalars {} (skipped {}, unit {}, general {}), chunks {}, methods {}, {} micros\n",
+      s.first, c.calls, c.scalars, c.skipped, c.unit, c.general, c.chunks, methods, c.micros);
+  }
+}
+
 void print_sum_bm(string msgtag, string bmlbl1, string bmlbl2, const Benchmarkable &obj)
 {
   double t1, t2;
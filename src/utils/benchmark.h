@@ -13,6 +13,7 @@
 #include <functional>
 
 #include "util.h"
+#include "instrument.h"
 #include "fmt/format.h"
 
 using namespace std;
@@ -22,6 +23,7 @@ class Benchmarkable;
 void print_bm(string msgtag, string bmlbl, const Benchmarkable &obj);
 void print_sum_bm(string msgtag, string bmlbl1, string bmlbl2, const Benchmarkable &obj);
 void fmt_time(string msgtag, double t);
+void print_mexp_counters(const cpstats::Sites &sites);
 
 
 
@@ -167,6 +169,24 @@ public:
     auto obj_session = obj+session;
     return (idmap.count(obj_session) != 0);
   }
+
+  // multiexp counters by call site (empty unless built with LEGO_INSTRUMENT)
+  cpstats::Sites getMexpCounters() const
+  {
+    return cpstats::snapshot();
+  }
+
+  cpstats::SiteCounters getMexpCountersFor(string site) const
+  {
+    auto sites = cpstats::snapshot();
+    auto it = sites.find(site);
+    return (it == sites.end()) ? cpstats::SiteCounters() : it->second;
+  }
+
+  void resetMexpCounters()
+  {
+    cpstats::reset();
+  }
 };
 
 
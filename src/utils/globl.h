@@ -6,6 +6,11 @@
 #include <libff/algebra/scalar_multiplication/multiexp.hpp>
 #include <libfqfft/polynomial_arithmetic/basic_operations.hpp>
 
+#include "multiexp.h"
+#include "threadpool.h"
+#include "glv.h"
+#include "span.h"
+
 
 using namespace libfqfft;
 using namespace libff;
@@ -40,41 +45,129 @@ inline void MYREQUIRE(bool b) {
 
 template<typename T>
 inline T mulEcByScalar(const T &pt, const LFr &x) {
-	return x*pt;
+	return cpglv::mul(x, pt);
 }
 
 
+/* The site argument names the caller in the multiexp counters (see instrument.h) */
+
 template<typename G>
-G multiExp(const vector<G> &gs, const  vector<LFr> &xs)
+G multiExp(const vector<G> &gs, const  vector<LFr> &xs, const char *site = "multiExp")
 {
   size_t n = min(gs.size(), xs.size());
-	#ifdef MULTICORE
-    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
-	#else
-    const size_t chunks = 1;
-	#endif
-
-	return libff::multi_exp<G, LFr, libff::multi_exp_method_bos_coster>(
-	  gs.begin(), gs.begin()+n,
-	  xs.begin(), xs.begin()+n,
-	  chunks);
+    const size_t chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
+
+	return cpmexp::multiExp<G, LFr>(gs, xs, n, chunks, cpmexp::Method::BosCoster, false, site);
 }
 
+// method: e.g. cpmexp::Method::BatchAffine for batch-affine buckets on G1 (a forced method still wins)
+// chunks: 0 for one per pool thread, fewer when the caller runs several multiexps concurrently
 template<typename G>
-G multiExpMA(const vector<G> &gs, const vector<LFr> &xs)
+G multiExpMA(
+	const vector<G> &gs, const vector<LFr> &xs, const char *site = "multiExpMA",
+	cpmexp::Method method = cpmexp::Method::Auto, size_t chunks = 0)
 {
   size_t n = min(gs.size(), xs.size());
-	#ifdef MULTICORE
-    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
-	#else
-    const size_t chunks = 1;
-	#endif
-      printf("NCHUNKS : %d\n", chunks);
-
-	return libff::multi_exp_with_mixed_addition<G, LFr, libff::multi_exp_method_BDLO12>(
-	  gs.begin(), gs.begin()+n,
-	  xs.begin(), xs.begin()+n,
-	  chunks);
+    if (chunks == 0) {
+      chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
+    }
+
+	return cpmexp::multiExp<G, LFr>(gs, xs, n, chunks, cpmexp::Method::BDLO12, true, site, method);
+}
+
+// multiExpMA on bases read through a view (e.g. of a mapped key)
+template<typename G>
+G multiExpMA(
+	cputil::Span<G> gs, const vector<LFr> &xs, const char *site = "multiExpMA",
+	cpmexp::Method method = cpmexp::Method::Auto, size_t chunks = 0)
+{
+  size_t n = min(gs.size(), xs.size());
+    if (chunks == 0) {
+      chunks = cppool::numThreads();
+    }
+
+	return cpmexp::multiExp<G, LFr>(gs, xs, n, chunks, cpmexp::Method::BDLO12, true, site, method);
+}
+
+// ret[t] = multiExpMA(gs, *xss[t]), with the shared bases read once for all vectors when possible
+template<typename G>
+vector<G> multiExpMulti(cputil::Span<G> gs, const vector<const vector<LFr> *> &xss, const char *site = "multiExpMulti")
+{
+    const size_t chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
+
+	return cpmexp::multiExpMulti<G, LFr>(gs.data(), gs.size(), xss, chunks, cpmexp::Method::BDLO12, true, site);
+}
+
+
+template<typename G>
+G multiExpFixedBase(
+	const cpmexp::FixedBaseTable<G> &tbl, const vector<LFr> &xs, const char *site = "multiExpFixedBase", size_t chunks = 0)
+{
+    if (chunks == 0) {
+      chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
+    }
+
+	return cpmexp::fixedBaseMultiExp<G, LFr>(tbl, xs, xs.size(), chunks, site);
+}
+
+// window table of g for batchExp: on G1 it covers the half-length GLV scalars only
+template<typename G>
+window_table<G> mkWindowTable(size_t fldBitSz, size_t window, const G &g)
+{
+    return get_window_table(cpglv::tableBits<G>(fldBitSz), window, g);
+}
+
+// batch_exp over slices of xs run on the thread pool (table from mkWindowTable)
+template<typename G>
+vector<G> batchExp(size_t fldBitSz, size_t window, const window_table<G> &tbl, const vector<LFr> &xs)
+{
+    const size_t n = xs.size();
+    const size_t chunks = std::max<size_t>(1, min(cppool::numThreads(), n));
+    vector<G> ret(n);
+    cppool::parallelFor(chunks, [&](size_t t) {
+      const size_t from = n*t/chunks;
+      const size_t to = n*(t+1)/chunks;
+      if constexpr (cpglv::Endo<G>::available) {
+        for (size_t i = from; i < to; i++) {
+          ret[i] = cpglv::tableMul(window, tbl, xs[i]);
+        }
+      } else {
+        vector<LFr> slice(xs.begin() + from, xs.begin() + to);
+        auto out = batch_exp(fldBitSz, window, tbl, slice);
+        std::copy(out.begin(), out.end(), ret.begin() + from);
+      }
+    });
+    return ret;
+}
+
+// key bases in affine form, one batched inversion per pool slice: multiexps over them then use mixed additions
+template<typename G>
+void normalizeBases(vector<G> &gs)
+{
+    const size_t n = gs.size();
+    const size_t chunks = std::max<size_t>(1, min(cppool::numThreads(), n));
+    cppool::parallelFor(chunks, [&](size_t t) {
+      vector<G> slice(gs.begin() + n*t/chunks, gs.begin() + n*(t+1)/chunks);
+      libff::batch_to_special(slice);
+      std::copy(slice.begin(), slice.end(), gs.begin() + n*t/chunks);
+    });
+}
+
+// xs[i]*G::one() for all i: batchExp with a window table sized for xs
+template<typename G>
+vector<G> generatorExps(const vector<LFr> &xs)
+{
+    const size_t fldBitSz = LFr::size_in_bits();
+    const size_t window = get_exp_window_size<G>(xs.size());
+    return batchExp(fldBitSz, window, mkWindowTable(fldBitSz, window, G::one()), xs);
+}
+
+template<typename G>
+cpmexp::FixedBaseTable<G> mkFixedBaseTable(cputil::Span<G> gs, size_t window)
+{
+    const size_t chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
+
+	return cpmexp::mkFixedBaseTable<G>(gs, window, LFr::size_in_bits(), chunks);
 }
 
 
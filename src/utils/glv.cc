@@ -0,0 +1,98 @@
+#include "glv.h"
+
+namespace cpglv {
+
+  const char *BETA = "2203960485148121921418603742825762020974279258880205651966";
+
+  namespace {
+    // scalar field modulus and a reduced basis {(a1, b1), (a2, b2)} of the lattice {(x, y): x + y*lambda = 0 mod r},
+    // lambda = 4407920970296243842393367215006156084916469457145843978461
+    const char *R = "21888242871839275222246405745257275088548364400416034343698204186575808495617";
+    const char *A1 = "9931322734385697763";
+    const char *B1 = "-147946756881789319000765030803803410728";
+    const char *A2 = "147946756881789319010696353538189108491";
+    const char *B2 = "9931322734385697763";
+
+    struct Basis {
+      mpz_t r, halfR, a1, b1, a2, b2;
+
+      Basis()
+      {
+        mpz_init_set_str(r, R, 10);
+        mpz_init(halfR);
+        mpz_fdiv_q_2exp(halfR, r, 1);
+        mpz_init_set_str(a1, A1, 10);
+        mpz_init_set_str(b1, B1, 10);
+        mpz_init_set_str(a2, A2, 10);
+        mpz_init_set_str(b2, B2, 10);
+      }
+      ~Basis()
+      {
+        mpz_clears(r, halfR, a1, b1, a2, b2, NULL);
+      }
+    };
+
+    const Basis &basis()
+    {
+      static const Basis b;
+      return b;
+    }
+  }
+
+  void decompose(const mpz_t k, mpz_t k1, mpz_t k2)
+  {
+    auto &B = basis();
+    mpz_t c1, c2, t;
+    mpz_inits(c1, c2, t, NULL);
+
+    // c1 = round(b2*k/r), c2 = round(-b1*k/r): the closest lattice vector is c1*(a1, b1) + c2*(a2, b2)
+    mpz_mul(c1, B.b2, k);
+    mpz_add(c1, c1, B.halfR);
+    mpz_fdiv_q(c1, c1, B.r);
+    mpz_neg(c2, B.b1);
+    mpz_mul(c2, c2, k);
+    mpz_add(c2, c2, B.halfR);
+    mpz_fdiv_q(c2, c2, B.r);
+
+    // (k1, k2) = (k, 0) - c1*(a1, b1) - c2*(a2, b2)
+    mpz_set(k1, k);
+    mpz_mul(t, c1, B.a1);
+    mpz_sub(k1, k1, t);
+    mpz_mul(t, c2, B.a2);
+    mpz_sub(k1, k1, t);
+
+    mpz_mul(k2, c1, B.b1);
+    mpz_neg(k2, k2);
+    mpz_mul(t, c2, B.b2);
+    mpz_sub(k2, k2, t);
+
+    mpz_clears(c1, c2, t, NULL);
+  }
+
+  vector<int> wnaf(const mpz_t k, size_t w)
+  {
+    vector<int> digits;
+    mpz_t e;
+    mpz_init_set(e, k);
+    const long full = 1L << w;
+    while (mpz_sgn(e) > 0) {
+      int d = 0;
+      if (mpz_odd_p(e)) {
+        d = mpz_fdiv_ui(e, full);
+        if (d >= full/2) {
+          d -= full;
+        }
+        if (d > 0) {
+          mpz_sub_ui(e, e, d);
+        } else {
+          mpz_add_ui(e, e, -d);
+        }
+      }
+      digits.push_back(d);
+      mpz_fdiv_q_2exp(e, e, 1);
+    }
+    mpz_clear(e);
+    return digits;
+  }
+
+} // end namespace cpglv
@@ -0,0 +1,216 @@
+#ifndef CP_GLV_H
+#define CP_GLV_H
+
+/* GLV endomorphism on G1 of the BN curves (BN128 and ALT_BN128 share the same curve y^2 = x^3 + 3).
+ * phi(x, y) = (beta*x, y) equals lambda*P, and every scalar k splits as k = k1 + k2*lambda (mod r)
+ * with |k1|, |k2| < 2^HALF_BITS: k*P = k1*P + k2*phi(P) needs half the doublings. */
+
+#include <libff/common/default_types/ec_pp.hpp>
+#include <libff/algebra/fields/bigint.hpp>
+
+#include <gmp.h>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <cstdlib>
+
+namespace cpglv {
+  using std::vector;
+  using std::size_t;
+
+  const size_t HALF_BITS = 128;
+
+  // k1 + k2*lambda = k (mod r), with the lattice basis of the BN254 scalar field
+  void decompose(const mpz_t k, mpz_t k1, mpz_t k2);
+
+  // signed digits of k >= 0 in width-w NAF, least significant first
+  vector<int> wnaf(const mpz_t k, size_t w);
+
+  // decimal beta, a primitive cube root of unity in the base field
+  extern const char *BETA;
+
+  template<mp_size_t N>
+  struct Split {
+    libff::bigint<N> k1, k2; // magnitudes
+    bool neg1 = false, neg2 = false;
+  };
+
+  template<typename FieldT>
+  Split<FieldT::num_limbs> split(const FieldT &x)
+  {
+    mpz_t k, k1, k2;
+    mpz_inits(k, k1, k2, NULL);
+    x.as_bigint().to_mpz(k);
+    decompose(k, k1, k2);
+
+    Split<FieldT::num_limbs> s;
+    s.neg1 = mpz_sgn(k1) < 0;
+    s.neg2 = mpz_sgn(k2) < 0;
+    mpz_abs(k1, k1);
+    mpz_abs(k2, k2);
+    s.k1 = libff::bigint<FieldT::num_limbs>(k1);
+    s.k2 = libff::bigint<FieldT::num_limbs>(k2);
+    mpz_clears(k, k1, k2, NULL);
+    return s;
+  }
+
+  // groups with the endomorphism
+  template<typename G>
+  struct Endo {
+    static const bool available = false;
+  };
+
+#ifdef CURVE_BN128
+  template<>
+  struct Endo<libff::bn128_G1> {
+    static const bool available = true;
+    static libff::bn128_G1 apply(const libff::bn128_G1 &P)
+    {
+      static const bn::Fp beta(BETA);
+      libff::bn128_G1 Q = P;
+      Q.X = Q.X * beta; // x = X/Z^2, so scaling X scales x
+      return Q;
+    }
+  };
+#endif
+
+#ifdef CURVE_ALT_BN128
+  template<>
+  struct Endo<libff::alt_bn128_G1> {
+    static const bool available = true;
+    static libff::alt_bn128_G1 apply(const libff::alt_bn128_G1 &P)
+    {
+      static const libff::alt_bn128_Fq beta(libff::bigint<libff::alt_bn128_q_limbs>(BETA));
+      libff::alt_bn128_G1 Q = P;
+      Q.X = Q.X * beta;
+      return Q;
+    }
+  };
+#endif
+
+  const size_t WNAF_WINDOW = 4;
+
+  /* sum of kss[v][i]*Ps[i] for each coefficient vector kss[v] over the same few points (Straus):
+   * the tables of odd multiples are built once and shared by all vectors, each vector gets one chain
+   * of doublings with wNAF digits, and with the endomorphism two half-length terms per scalar */
+  template<typename G, typename FieldT>
+  vector<G> mulManyMulti(const vector<vector<FieldT>> &kss, const vector<G> &Ps)
+  {
+    const size_t nOdd = size_t(1) << (WNAF_WINDOW-2); // P, 3P, ..., (2^(w-1)-1)P
+    const size_t termsPerPt = Endo<G>::available ? 2 : 1;
+    vector<vector<G>> tables;
+    for (size_t i = 0; i < Ps.size(); i++) {
+      vector<G> tbl(nOdd);
+      tbl[0] = Ps[i];
+      const G twice = Ps[i].dbl();
+      for (size_t j = 1; j < nOdd; j++) {
+        tbl[j] = tbl[j-1] + twice;
+      }
+      tables.push_back(tbl);
+      if constexpr (Endo<G>::available) {
+        for (auto &T : tbl) {
+          T = Endo<G>::apply(T);
+        }
+        tables.push_back(tbl);
+      }
+    }
+
+    vector<G> out;
+    out.reserve(kss.size());
+    mpz_t m;
+    mpz_init(m);
+    for (auto &ks : kss) {
+      vector<vector<int>> digits(tables.size());
+      vector<char> negs(tables.size(), 0);
+      for (size_t i = 0; i < ks.size(); i++) {
+        if constexpr (Endo<G>::available) {
+          auto s = split(ks[i]);
+          s.k1.to_mpz(m);
+          digits[2*i] = wnaf(m, WNAF_WINDOW);
+          negs[2*i] = s.neg1;
+          s.k2.to_mpz(m);
+          digits[2*i+1] = wnaf(m, WNAF_WINDOW);
+          negs[2*i+1] = s.neg2;
+        } else {
+          ks[i].as_bigint().to_mpz(m);
+          digits[i] = wnaf(m, WNAF_WINDOW);
+        }
+      }
+
+      size_t len = 0;
+      for (auto &d : digits) {
+        len = std::max(len, d.size());
+      }
+      G acc = G::zero();
+      for (size_t b = len; b-- > 0; ) {
+        acc = acc.dbl();
+        for (size_t t = 0; t < ks.size()*termsPerPt; t++) {
+          if (b >= digits[t].size() || digits[t][b] == 0) {
+            continue;
+          }
+          const int d = digits[t][b];
+          const G &T = tables[t][std::abs(d)/2];
+          acc = ((d < 0) != bool(negs[t])) ? acc - T : acc + T;
+        }
+      }
+      out.push_back(acc);
+    }
+    mpz_clear(m);
+    return out;
+  }
+
+  template<typename G, typename FieldT>
+  G mulMany(const vector<FieldT> &ks, const vector<G> &Ps)
+  {
+    return mulManyMulti<G, FieldT>(vector<vector<FieldT>>{ks}, Ps)[0];
+  }
+
+  template<typename G, typename FieldT>
+  G mul(const FieldT &k, const G &P)
+  {
+    return mulMany<G, FieldT>(vector<FieldT>{k}, vector<G>{P});
+  }
+
+  /* Fixed-base window tables (libff window_table, table[j][d] = d*2^(j*window)*g).
+   * With the endomorphism they only need to cover half-length scalars. */
+  template<typename G>
+  size_t tableBits(size_t fldBitSz)
+  {
+    return Endo<G>::available ? HALF_BITS : fldBitSz;
+  }
+
+  template<typename G, mp_size_t N>
+  G windowTableMul(size_t window, const vector<vector<G>> &table, const libff::bigint<N> &k)
+  {
+    G res = G::zero();
+    for (size_t outer = 0; outer < table.size(); outer++) {
+      size_t inner = 0;
+      for (size_t b = 0; b < window; b++) {
+        if (k.test_bit(outer*window + b)) {
+          inner |= size_t(1) << b;
+        }
+      }
+      if (inner != 0) {
+        res = res + table[outer][inner];
+      }
+    }
+    return res;
+  }
+
+  // k*g from a window table of g over tableBits<G>() bits
+  template<typename G, typename FieldT>
+  G tableMul(size_t window, const vector<vector<G>> &table, const FieldT &k)
+  {
+    if constexpr (!Endo<G>::available) {
+      return windowTableMul(window, table, k.as_bigint());
+    } else {
+      auto s = split(k);
+      G r1 = windowTableMul(window, table, s.k1);
+      G r2 = windowTableMul(window, table, s.k2);
+      return (s.neg1 ? -r1 : r1) + Endo<G>::apply(s.neg2 ? -r2 : r2);
+    }
+  }
+
+} // end namespace cpglv
+
+#endif
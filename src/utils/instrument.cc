@@ -0,0 +1,49 @@
+#include "instrument.h"
+
+#include <mutex>
+
+namespace cpstats {
+
+  namespace {
+    std::mutex sitesMtx;
+
+    Sites &sites()
+    {
+      static Sites s;
+      return s;
+    }
+  }
+
+  void SiteCounters::merge(const SiteCounters &o)
+  {
+    calls += o.calls;
+    scalars += o.scalars;
+    chunks = o.chunks;
+    skipped += o.skipped;
+    unit += o.unit;
+    general += o.general;
+    micros += o.micros;
+    for (auto &m : o.methods) {
+      methods[m.first] += m.second;
+    }
+  }
+
+  Sites snapshot()
+  {
+    std::lock_guard<std::mutex> lk(sitesMtx);
+    return sites();
+  }
+
+  void reset()
+  {
+    std::lock_guard<std::mutex> lk(sitesMtx);
+    sites().clear();
+  }
+
+  void add(const std::string &site, const SiteCounters &delta)
+  {
+    std::lock_guard<std::mutex> lk(sitesMtx);
+    sites()[site].merge(delta);
+  }
+
+} // end namespace cpstats
@@ -0,0 +1,112 @@
+#ifndef CP_INSTRUMENT_H
+#define CP_INSTRUMENT_H
+
+/* Per-call-site counters for the multiexp hot paths (multiexps, fixed-base and sparse multiexps).
+ * They are collected only when built with LEGO_INSTRUMENT (CMake option INSTRUMENT);
+ * otherwise a Record is an empty object and recording compiles to nothing. */
+
+#include <map>
+#include <string>
+#include <cstddef>
+#include <chrono>
+
+namespace cpstats {
+  using std::size_t;
+
+  struct SiteCounters {
+    size_t calls = 0;
+    size_t scalars = 0; // input sizes summed over calls
+    size_t chunks = 0; // chunks of the last call
+    size_t skipped = 0; // zero scalars
+    size_t unit = 0; // scalars equal to one (plain additions)
+    size_t general = 0; // scalars left to an actual multiexp
+    long micros = 0; // elapsed time summed over calls
+    std::map<std::string, size_t> methods; // calls per method
+
+    void merge(const SiteCounters &o);
+  };
+
+  using Sites = std::map<std::string, SiteCounters>;
+
+  constexpr bool enabled()
+  {
+#ifdef LEGO_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // counters collected so far, by call site
+  Sites snapshot();
+  void reset();
+  void add(const std::string &site, const SiteCounters &delta);
+
+#ifdef LEGO_INSTRUMENT
+
+  // counters of one call, added to its site when it goes out of scope
+  class Record {
+  public:
+    explicit Record(const char *_site) : site(_site), begin(std::chrono::high_resolution_clock::now()) { }
+
+    ~Record()
+    {
+      auto end = std::chrono::high_resolution_clock::now();
+      delta.calls = 1;
+      delta.micros = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+      add(site, delta);
+    }
+
+    void size(size_t n) { delta.scalars += n; }
+    void chunks(size_t c) { delta.chunks = c; }
+    void method(const char *m) { delta.methods[m]++; }
+    void split(size_t skipped, size_t unit, size_t general)
+    {
+      delta.skipped += skipped;
+      delta.unit += unit;
+      delta.general += general;
+    }
+
+    // zero/one/other split of the first n scalars
+    template<typename FieldT>
+    void classify(const FieldT *xs, size_t n)
+    {
+      const FieldT zero = FieldT::zero();
+      const FieldT one = FieldT::one();
+      size_t nZero = 0, nOne = 0;
+      for (size_t i = 0; i < n; i++) {
+        if (xs[i] == zero) {
+          nZero++;
+        } else if (xs[i] == one) {
+          nOne++;
+        }
+      }
+      split(nZero, nOne, n - nZero - nOne);
+    }
+
+  private:
+    const char *site;
+    std::chrono::high_resolution_clock::time_point begin;
+    SiteCounters delta;
+  };
+
+#else
+
+  class Record {
+  public:
+    explicit Record(const char *) { }
+
+    void size(size_t) { }
+    void chunks(size_t) { }
+    void method(const char *) { }
+    void split(size_t, size_t, size_t) { }
+
+    template<typename FieldT>
+    void classify(const FieldT *, size_t) { }
+  };
+
+#endif
+
+} // end namespace cpstats
+
+#endif
@@ -0,0 +1,136 @@
+#include "keyfile.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace cpkeyfile {
+
+  namespace {
+    const size_t ALIGN = 64;
+    const char MAGIC[8] = { 'L', 'E', 'G', 'O', 'K', 'E', 'Y', '1' };
+
+    struct Header {
+      char magic[8];
+      uint32_t kind;
+      uint32_t reserved;
+      char curve[16];
+    };
+  }
+
+  const char *curveName()
+  {
+#if defined(CURVE_BN128)
+    return "BN128";
+#elif defined(CURVE_ALT_BN128)
+    return "ALT_BN128";
+#elif defined(CURVE_EDWARDS)
+    return "EDWARDS";
+#elif defined(CURVE_MNT4)
+    return "MNT4";
+#elif defined(CURVE_MNT6)
+    return "MNT6";
+#else
+    return "UNKNOWN";
+#endif
+  }
+
+  MappedFile::MappedFile(const std::string &path)
+  {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open key file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat key file " + path);
+    }
+    len = st.st_size;
+    if (len > 0) {
+      void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map key file " + path);
+      }
+      ptr = static_cast<const char *>(p);
+    }
+    ::close(fd); // the mapping stays valid
+  }
+
+  MappedFile::~MappedFile()
+  {
+    if (ptr) {
+      munmap(const_cast<char *>(ptr), len);
+    }
+  }
+
+  Writer::Writer(const std::string &path, Kind kind) : out(path, std::ios::binary | std::ios::trunc)
+  {
+    if (!out) {
+      throw std::runtime_error("Cannot create key file " + path);
+    }
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.kind = uint32_t(kind);
+    strncpy(h.curve, curveName(), sizeof(h.curve) - 1);
+    write(&h, sizeof(h));
+  }
+
+  void Writer::write(const void *p, size_t len)
+  {
+    out.write(static_cast<const char *>(p), len);
+    if (!out) {
+      throw std::runtime_error("Error writing key file");
+    }
+    pos += len;
+  }
+
+  void Writer::align()
+  {
+    static const char zeros[ALIGN] = { 0 };
+    write(zeros, (ALIGN - pos % ALIGN) % ALIGN);
+  }
+
+  void Writer::close()
+  {
+    out.close();
+    if (!out) {
+      throw std::runtime_error("Error closing key file");
+    }
+  }
+
+  Reader::Reader(const std::string &path, Kind kind) : file(std::make_shared<MappedFile>(path))
+  {
+    Header h;
+    read(&h, sizeof(h));
+    if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+      throw std::runtime_error("Not a key file: " + path);
+    }
+    if (h.kind != uint32_t(kind)) {
+      throw std::runtime_error("Key file holds another kind of key: " + path);
+    }
+    h.curve[sizeof(h.curve) - 1] = 0;
+    if (strcmp(h.curve, curveName()) != 0) {
+      throw std::runtime_error("Key file is for curve " + std::string(h.curve) + ": " + path);
+    }
+  }
+
+  void Reader::read(void *p, size_t len)
+  {
+    if (pos + len > file->size()) {
+      throw std::runtime_error("Key file truncated.");
+    }
+    memcpy(p, file->data() + pos, len);
+    pos += len;
+  }
+
+  void Reader::align()
+  {
+    pos += (ALIGN - pos % ALIGN) % ALIGN;
+  }
+
+} // end namespace cpkeyfile
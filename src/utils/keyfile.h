@@ -0,0 +1,155 @@
+#ifndef CP_KEYFILE_H
+#define CP_KEYFILE_H
+
+/* Binary key files: a header, then values and arrays of group/field elements in the in-memory
+ * representation of this build, each array 64-byte aligned. Loading maps the file and uses the
+ * arrays in place (no parsing); element sizes, curve and kind of key are checked on the way in,
+ * so files written by another build are refused rather than misread. */
+
+#include "span.h"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace cpkeyfile {
+  using std::vector;
+  using std::size_t;
+
+  // read-only mapping of a whole file
+  class MappedFile
+  {
+  public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return ptr; }
+    size_t size() const { return len; }
+
+  private:
+    const char *ptr = nullptr;
+    size_t len = 0;
+  };
+
+  // elements owned in a vector, or read in place from a mapped file that the array keeps alive
+  template<typename T>
+  class Array
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "key file elements are read in place from their bytes");
+
+  public:
+    Array() { }
+    Array(vector<T> v) : owned(std::move(v)) { }
+    Array(std::shared_ptr<const MappedFile> _file, const T *p, size_t n) : file(_file), mapped(p, n) { }
+
+    cputil::Span<T> view() const { return file ? mapped : cputil::Span<T>(owned); }
+    operator cputil::Span<T>() const { return view(); }
+
+    size_t size() const { return view().size(); }
+    const T &operator[](size_t i) const { return view()[i]; }
+    const T *begin() const { return view().begin(); }
+    const T *end() const { return view().end(); }
+
+    bool isMapped() const { return bool(file); }
+
+    // the elements in a vector of their own, to modify them (a mapped array is copied out first)
+    vector<T> &own()
+    {
+      if (file) {
+        owned = mapped.toVector();
+        file.reset();
+        mapped = cputil::Span<T>();
+      }
+      return owned;
+    }
+
+  private:
+    vector<T> owned;
+    std::shared_ptr<const MappedFile> file;
+    cputil::Span<T> mapped;
+  };
+
+  enum class Kind : uint32_t { CommKey = 1, InterpCommKey = 2 };
+
+  // name of the curve this build uses, as recorded in the header
+  const char *curveName();
+
+  class Writer
+  {
+  public:
+    Writer(const std::string &path, Kind kind);
+
+    template<typename T>
+    void value(const T &x)
+    {
+      array(cputil::Span<T>(&x, 1));
+    }
+
+    template<typename T>
+    void array(cputil::Span<T> xs)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "key file elements are written as their bytes");
+      const uint64_t meta[2] = { xs.size(), sizeof(T) };
+      write(meta, sizeof(meta));
+      align();
+      write(xs.data(), xs.size()*sizeof(T));
+    }
+
+    void close();
+
+  private:
+    std::ofstream out;
+    size_t pos = 0;
+
+    void write(const void *p, size_t len);
+    void align();
+  };
+
+  class Reader
+  {
+  public:
+    Reader(const std::string &path, Kind kind);
+
+    template<typename T>
+    T value()
+    {
+      return array<T>()[0];
+    }
+
+    template<typename T>
+    Array<T> array()
+    {
+      uint64_t meta[2];
+      read(meta, sizeof(meta));
+      if (meta[1] != sizeof(T)) {
+        throw std::runtime_error("Key file written with a different element layout.");
+      }
+      align();
+      // meta[0] comes from the file: compared by division so that a corrupt count cannot overflow
+      if (pos > file->size() || meta[0] > (file->size() - pos) / sizeof(T)) {
+        throw std::runtime_error("Key file truncated.");
+      }
+      const size_t len = meta[0]*sizeof(T);
+      Array<T> arr(file, reinterpret_cast<const T *>(file->data() + pos), meta[0]);
+      pos += len;
+      return arr;
+    }
+
+  private:
+    std::shared_ptr<const MappedFile> file;
+    size_t pos = 0;
+
+    void read(void *p, size_t len);
+    void align();
+  };
+
+} // end namespace cpkeyfile
+
+#endif
@@ -52,8 +52,9 @@ void insertAsColMajor(const size_t r, const size_t c, const T &v, vector<vector<
 	m[c].push_back(CoeffPos<T>(v, r));
 }
 
-template<typename T>
-void insertRowAsColMajor(const size_t r, const size_t offset_c, const vector<T> &v, vector<vector<CoeffPos<T>>> &m)
+// v: any sequence of T, e.g. a vector or a cputil::Span of commitment bases
+template<typename T, typename Row>
+void insertRowAsColMajor(const size_t r, const size_t offset_c, const Row &v, vector<vector<CoeffPos<T>>> &m)
 {
 	for (auto i = 0; i < v.size(); i++) {
 		insertAsColMajor(r, offset_c+i, v[i], m);
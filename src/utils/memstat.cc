@@ -0,0 +1,52 @@
+#include "memstat.h"
+
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <unistd.h>
+
+namespace cpmem {
+
+  size_t residentBytes()
+  {
+    std::ifstream in("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(in >> pages >> resident)) {
+      return 0;
+    }
+    return resident*size_t(sysconf(_SC_PAGESIZE));
+  }
+
+  size_t peakBytes()
+  {
+    std::ifstream in("/proc/self/status");
+    std::string key;
+    while (in >> key) {
+      if (key == "VmHWM:") {
+        size_t kb = 0;
+        in >> kb;
+        return kb*1024;
+      }
+      std::getline(in, key);
+    }
+    return 0;
+  }
+
+  PeakTracker::PeakTracker() : start(residentBytes()), sampled(start), kernelPeakAtStart(peakBytes())
+  {
+  }
+
+  void PeakTracker::sample()
+  {
+    sampled = std::max(sampled, residentBytes());
+  }
+
+  size_t PeakTracker::peakAboveStart()
+  {
+    sample();
+    const size_t kernelPeak = peakBytes();
+    const size_t peak = kernelPeak > kernelPeakAtStart ? std::max(sampled, kernelPeak) : sampled;
+    return peak > start ? peak - start : 0;
+  }
+
+} // end namespace cpmem
@@ -0,0 +1,36 @@
+#ifndef CP_MEMSTAT_H
+#define CP_MEMSTAT_H
+
+/* Resident memory of the process, from /proc/self (Linux; zeros elsewhere). Peaks are process-wide:
+ * a PeakTracker around a proof also sees whatever other threads allocate meanwhile. */
+
+#include <cstddef>
+
+namespace cpmem {
+  using std::size_t;
+
+  // resident set now (/proc/self/statm)
+  size_t residentBytes();
+
+  // highest resident set since the process started (VmHWM in /proc/self/status)
+  size_t peakBytes();
+
+  /* peak resident memory over a scope, above what was resident when it began. The kernel peak is read,
+   * never reset, so outer measurements are left intact: it is exact when the scope raises the process
+   * high-water mark, and otherwise only the resident sets seen at sample() points count. */
+  class PeakTracker {
+  public:
+    PeakTracker();
+
+    void sample();
+    size_t peakAboveStart();
+
+  private:
+    size_t start;
+    size_t sampled;
+    size_t kernelPeakAtStart;
+  };
+
+} // end namespace cpmem
+
+#endif
@@ -0,0 +1,143 @@
+#include "multiexp.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+
+namespace cpmexp {
+
+  Config &config()
+  {
+    static Config cfg = []() {
+      Config c;
+      if (const char *m = getenv("LEGO_MEXP_METHOD")) {
+        c.method = methodFromName(m);
+      }
+      if (const char *w = getenv("LEGO_MEXP_WINDOW")) {
+        c.window = std::stoul(w);
+      }
+      if (const char *g = getenv("LEGO_MEXP_GLV")) {
+        c.glv = std::string(g) != "0";
+      }
+      return c;
+    }();
+    return cfg;
+  }
+
+  void forceMethod(Method m)
+  {
+    config().method = m;
+  }
+
+  void forceWindow(size_t c)
+  {
+    if (c > PIPPENGER_MAX_WINDOW) {
+      throw std::runtime_error("Pippenger window too large");
+    }
+    config().window = c;
+  }
+
+  void useGLV(bool on)
+  {
+    config().glv = on;
+  }
+
+  const char *methodName(Method m)
+  {
+    switch (m) {
+      case Method::Auto: return "auto";
+      case Method::Naive: return "naive";
+      case Method::BosCoster: return "bos_coster";
+      case Method::BDLO12: return "bdlo12";
+      case Method::Pippenger: return "pippenger";
+      case Method::BatchAffine: return "batch_affine";
+    }
+    return "unknown";
+  }
+
+  const char *methodName(libff::multi_exp_method m)
+  {
+    switch (m) {
+      case libff::multi_exp_method_naive: return "naive";
+      case libff::multi_exp_method_naive_plain: return "naive_plain";
+      case libff::multi_exp_method_bos_coster: return "bos_coster";
+      case libff::multi_exp_method_BDLO12: return "bdlo12";
+    }
+    return "unknown";
+  }
+
+  Method methodFromName(const std::string &name)
+  {
+    for (auto m : {Method::Auto, Method::Naive, Method::BosCoster, Method::BDLO12, Method::Pippenger, Method::BatchAffine}) {
+      if (name == methodName(m)) {
+        return m;
+      }
+    }
+    throw std::runtime_error("Unknown multiexp method " + name);
+  }
+
+  size_t pippengerWindow(size_t n, size_t nBits, bool signedDigits)
+  {
+    // cost in group additions: (nBits/c) windows, each with n bucket additions and two per bucket for the running sum
+    size_t best = 1;
+    double bestCost = -1;
+    for (size_t c = 1; c <= PIPPENGER_MAX_WINDOW; c++) {
+      double nWindows = signedDigits ? signedWindows(nBits, c) : (nBits + c - 1) / c;
+      double nBuckets = signedDigits ? (double)(size_t(1) << (c-1)) : (double)(size_t(1) << c);
+      double cost = nWindows * (n + 2*nBuckets);
+      if (bestCost < 0 || cost < bestCost) {
+        best = c;
+        bestCost = cost;
+      }
+    }
+    return best;
+  }
+
+  size_t fixedBaseWindow(size_t n, size_t nBits, size_t chunks)
+  {
+    // cost in group additions: n*nWindows into the buckets, then two per bucket and chunk for the running sum
+    size_t best = 1;
+    double bestCost = -1;
+    for (size_t c = 1; c <= PIPPENGER_MAX_WINDOW; c++) {
+      double nWindows = (nBits + c - 1) / c;
+      double nBuckets = (double)((size_t(1) << c) - 1);
+      double cost = n*nWindows + 2*nBuckets*std::max<size_t>(1, chunks);
+      if (bestCost < 0 || cost < bestCost) {
+        best = c;
+        bestCost = cost;
+      }
+    }
+    return best;
+  }
+
+  namespace {
+    thread_local size_t bitsHint = 0;
+  }
+
+  ScalarBitsHint::ScalarBitsHint(size_t bits) : prev(bitsHint)
+  {
+    bitsHint = bits;
+  }
+
+  ScalarBitsHint::~ScalarBitsHint()
+  {
+    bitsHint = prev;
+  }
+
+  size_t scalarBitsHint()
+  {
+    return bitsHint;
+  }
+
+  Method chooseMethod(size_t n, Method fallback, Method preferred)
+  {
+    if (config().method != Method::Auto) {
+      return config().method;
+    }
+    if (preferred != Method::Auto) {
+      return preferred;
+    }
+    return (n < PIPPENGER_MIN_SIZE) ? fallback : Method::Pippenger;
+  }
+
+} // end namespace cpmexp
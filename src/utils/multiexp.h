@@ -0,0 +1,855 @@
+#ifndef CP_MULTIEXP_H
+#define CP_MULTIEXP_H
+
+/* Multi-exponentiation engine: a bucket (Pippenger) method next to the libff ones,
+ * with the method and window picked from the input size unless forced at runtime. */
+
+#include <libff/common/default_types/ec_pp.hpp>
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+
+#include "threadpool.h"
+#include "instrument.h"
+#include "glv.h"
+#include "span.h"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+#include <cstdlib>
+
+namespace cpmexp {
+  using std::vector;
+  using std::size_t;
+
+  // BatchAffine: Pippenger with batch-affine buckets (G1; other groups use Pippenger)
+  enum class Method { Auto, Naive, BosCoster, BDLO12, Pippenger, BatchAffine };
+
+  struct Config {
+    Method method = Method::Auto; // Auto: choose from input size
+    size_t window = 0; // 0: choose from input size (Pippenger only)
+    bool glv = true; // split scalars with the endomorphism where the group has one (Pippenger only)
+  };
+
+  // Process-wide settings; LEGO_MEXP_METHOD, LEGO_MEXP_WINDOW and LEGO_MEXP_GLV override the defaults
+  Config &config();
+  void forceMethod(Method m);
+  void forceWindow(size_t c);
+  void useGLV(bool on);
+
+  const char *methodName(Method m);
+  const char *methodName(libff::multi_exp_method m);
+  Method methodFromName(const std::string &name);
+
+  // below this many bases Auto keeps the libff method of the caller
+  const size_t PIPPENGER_MIN_SIZE = 64;
+  const size_t PIPPENGER_MAX_WINDOW = 16;
+
+  // window minimizing the number of additions for n scalars of nBits bits (in signed digits if signedDigits)
+  size_t pippengerWindow(size_t n, size_t nBits, bool signedDigits = false);
+
+  /* window of a fixed-base table for n bases: one bucket pass does all windows, so the cost is
+   * n*ceil(nBits/c) mixed additions plus the bucket sums of each chunk, and larger windows pay off
+   * (the table also shrinks with c) */
+  size_t fixedBaseWindow(size_t n, size_t nBits, size_t chunks = 1);
+
+  // forced method if any, else the caller's preferred one, else from the input size
+  Method chooseMethod(size_t n, Method fallback, Method preferred = Method::Auto);
+
+  /* Bucket multiexps only process as many bits as the largest scalar has (e.g. 32 for 32-bit witnesses).
+   * While a ScalarBitsHint is in scope, the multiexps started by this thread take its bound instead of
+   * scanning the scalars: it must hold for all of them. */
+  class ScalarBitsHint {
+  public:
+    explicit ScalarBitsHint(size_t bits);
+    ~ScalarBitsHint();
+  private:
+    size_t prev;
+  };
+
+  size_t scalarBitsHint(); // 0 if none
+
+
+  // body(i) for every i in [0, n): on the thread pool unless chunks is 1
+  template<typename F>
+  inline void forEach(size_t n, size_t chunks, F body)
+  {
+    if (chunks > 1) {
+      cppool::parallelFor(n, body);
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        body(i);
+      }
+    }
+  }
+
+  // c bits of e starting at bit offset
+  template<mp_size_t N>
+  inline size_t windowDigit(const libff::bigint<N> &e, size_t offset, size_t c)
+  {
+    const size_t limbBits = GMP_NUMB_BITS;
+    const size_t limb = offset / limbBits;
+    const size_t shift = offset % limbBits;
+    if (limb >= N) {
+      return 0;
+    }
+    mp_limb_t v = e.data[limb] >> shift;
+    if (shift + c > limbBits && limb + 1 < N) {
+      v |= e.data[limb+1] << (limbBits - shift);
+    }
+    return v & ((mp_limb_t(1) << c) - 1);
+  }
+
+  // Affine: the base is known to be in affine form (e.g. a key normalized at keygen)
+  template<bool Affine = false, typename G>
+  inline void bucketAdd(G &bucket, const G &base)
+  {
+#ifdef USE_MIXED_ADDITION
+    bucket = bucket.mixed_add(base);
+#else
+    if constexpr (Affine) {
+      bucket = bucket.mixed_add(base);
+    } else {
+      bucket = bucket + base;
+    }
+#endif
+  }
+
+  template<typename G>
+  bool allAffine(const G *bases, size_t n)
+  {
+    return std::all_of(bases, bases+n, [](const G &g) { return g.is_special(); });
+  }
+
+  /* Signed windows: every digit but the top one is recoded into [-2^(c-1), 2^(c-1)) by carrying
+   * into the next window, and the top one is at most 2^(c-1). Since negating a base is free,
+   * a window needs 2^(c-1) buckets instead of 2^c - 1. */
+  inline size_t signedWindows(size_t nBits, size_t c)
+  {
+    return (nBits + c) / c; // the top window holds at most c-1 bits plus a carry
+  }
+
+  template<mp_size_t N>
+  inline long signedDigit(const libff::bigint<N> &e, char carry, size_t j, size_t nWindows, size_t c)
+  {
+    long d = windowDigit(e, j*c, c) + carry;
+    if (j+1 < nWindows && d >= (1L << (c-1))) {
+      d -= 1L << c;
+    }
+    return d;
+  }
+
+  // carries[j] is the carry into window j of the recoding of e
+  template<mp_size_t N>
+  void signedCarries(const libff::bigint<N> &e, size_t nWindows, size_t c, char *carries)
+  {
+    char carry = 0;
+    for (size_t j = 0; j < nWindows; j++) {
+      carries[j] = carry;
+      carry = (windowDigit(e, j*c, c) + carry >= (size_t(1) << (c-1)));
+    }
+  }
+
+  /* GLV terms are not stored: term 2i is P_i and term 2i+1 is phi(P_i) (x scaled by beta, so an affine base
+   * stays affine), each with the sign of its half-scalar. The bucket step builds the term it adds. */
+  template<typename G>
+  inline G glvTerm(const G *bases, size_t e, bool neg)
+  {
+    G P = bases[e/2];
+    if constexpr (cpglv::Endo<G>::available) {
+      if (e & 1) {
+        P = cpglv::Endo<G>::apply(P);
+      }
+    }
+    return neg ? -P : P;
+  }
+
+  // sum over terms e of d_e*term_e, where d_e is the signed digit of exps[e] at window j;
+  // term_e is bases[e], or the GLV term e of bases with sign negs[e] when negs is given
+  template<bool Affine, typename G, mp_size_t N>
+  G bucketWindowSum(const G *bases, const libff::bigint<N> *exps, const char *negs, const char *carries, size_t n, size_t j, size_t nWindows, size_t c)
+  {
+    vector<G> buckets(size_t(1) << (c-1), G::zero());
+    for (size_t e = 0; e < n; e++) {
+      auto d = signedDigit(exps[e], carries[e*nWindows + j], j, nWindows, c);
+      if (d == 0) {
+        continue;
+      }
+      G &bucket = buckets[std::labs(d)-1];
+      if (negs) {
+        bucketAdd<Affine>(bucket, glvTerm(bases, e, (d < 0) != bool(negs[e])));
+      } else if (d > 0) {
+        bucketAdd<Affine>(bucket, bases[e]);
+      } else {
+        bucketAdd<Affine>(bucket, -bases[e]);
+      }
+    }
+
+    // running sum: bucket k is added k+1 times
+    G running = G::zero();
+    G acc = G::zero();
+    for (size_t k = buckets.size(); k-- > 0; ) {
+      running = running + buckets[k];
+      acc = acc + running;
+    }
+    return acc;
+  }
+
+  // bits to process for the exponents exps[0..n) of at most fullBits bits
+  template<mp_size_t N>
+  size_t scalarBits(const libff::bigint<N> *exps, size_t n, size_t fullBits)
+  {
+    if (size_t hint = scalarBitsHint()) {
+      return std::min(hint, fullBits);
+    }
+    libff::bigint<N> acc; // or of all exponents
+    for (size_t i = 0; i < n; i++) {
+      for (mp_size_t l = 0; l < N; l++) {
+        acc.data[l] |= exps[i].data[l];
+      }
+    }
+    return std::max<size_t>(1, std::min(fullBits, acc.num_bits()));
+  }
+
+  // as above, from the field elements without keeping their bigints
+  template<typename FieldT>
+  size_t scalarBits(const FieldT *scalars, size_t n)
+  {
+    const size_t fullBits = FieldT::size_in_bits();
+    if (size_t hint = scalarBitsHint()) {
+      return std::min(hint, fullBits);
+    }
+    libff::bigint<FieldT::num_limbs> acc;
+    for (size_t i = 0; i < n; i++) {
+      const auto e = scalars[i].as_bigint();
+      for (mp_size_t l = 0; l < FieldT::num_limbs; l++) {
+        acc.data[l] |= e.data[l];
+      }
+    }
+    return std::max<size_t>(1, std::min(fullBits, acc.num_bits()));
+  }
+
+  // Horner on 2^c from the most significant window down
+  template<typename G>
+  G combineWindows(const vector<G> &windowSums, size_t c)
+  {
+    G acc = windowSums.back();
+    for (size_t j = windowSums.size()-1; j-- > 0; ) {
+      for (size_t k = 0; k < c; k++) {
+        acc = acc.dbl();
+      }
+      acc = acc + windowSums[j];
+    }
+    return acc;
+  }
+
+  // n terms: n bases, or n/2 bases with their GLV terms when negs is given
+  template<typename G, mp_size_t N>
+  G pippengerExps(const G *bases, const libff::bigint<N> *exps, const char *negs, size_t n, size_t nBits, size_t c, size_t chunks)
+  {
+    if (c == 0) {
+      c = pippengerWindow(n, nBits, true);
+    }
+    const size_t nWindows = signedWindows(nBits, c);
+
+    vector<char> carries(n*nWindows);
+    forEach(n, chunks, [&](size_t i) {
+      signedCarries(exps[i], nWindows, c, &carries[i*nWindows]);
+    });
+
+    // affine bases (keys normalized at keygen) take mixed additions
+    const bool affine = allAffine(bases, negs ? n/2 : n);
+    vector<G> windowSums(nWindows);
+    forEach(nWindows, chunks, [&](size_t j) {
+      windowSums[j] = affine ?
+        bucketWindowSum<true>(bases, exps, negs, carries.data(), n, j, nWindows, c) :
+        bucketWindowSum<false>(bases, exps, negs, carries.data(), n, j, nWindows, c);
+    });
+    return combineWindows(windowSums, c);
+  }
+
+  template<typename G>
+  bool useEndo()
+  {
+    return cpglv::Endo<G>::available && config().glv;
+  }
+
+  /* GLV: the same multiexp over 2n terms with half-length exponents,
+   * k_i*P_i = |k1|*(+-P_i) + |k2|*(+-phi(P_i)); the bucket passes and the doublings are halved.
+   * Only the half-scalars and their signs are stored (exps[2i], exps[2i+1]); see glvTerm. */
+  template<typename FieldT>
+  void glvSplit(
+    const FieldT *scalars, size_t n, size_t chunks,
+    vector<libff::bigint<FieldT::num_limbs>> &outExps, vector<char> &outNegs)
+  {
+    outExps.resize(2*n);
+    outNegs.resize(2*n);
+    forEach(n, chunks, [&](size_t i) {
+      auto sp = cpglv::split(scalars[i]);
+      outExps[2*i] = sp.k1;
+      outNegs[2*i] = sp.neg1;
+      outExps[2*i+1] = sp.k2;
+      outNegs[2*i+1] = sp.neg2;
+    });
+  }
+
+  template<typename G, typename FieldT>
+  G pippenger(const G *bases, const FieldT *scalars, size_t n, size_t c, size_t chunks)
+  {
+    using BigT = libff::bigint<FieldT::num_limbs>;
+    const size_t nBits = scalarBits(scalars, n);
+
+    // short scalars gain nothing from the split
+    if (useEndo<G>() && nBits > cpglv::HALF_BITS) {
+      vector<BigT> glvExps;
+      vector<char> negs;
+      glvSplit(scalars, n, chunks, glvExps, negs);
+      return pippengerExps(bases, glvExps.data(), negs.data(), 2*n, cpglv::HALF_BITS, c, chunks);
+    }
+    vector<BigT> exps(n);
+    for (size_t i = 0; i < n; i++) {
+      exps[i] = scalars[i].as_bigint();
+    }
+    return pippengerExps(bases, exps.data(), (const char *)nullptr, n, nBits, c, chunks);
+  }
+
+  /* Batch-affine buckets (G1 only): buckets are kept in affine form and the pending additions
+   * of a batch share one field inversion (Montgomery's trick), so each bucket addition costs
+   * about 6 field multiplications instead of the 11 of a mixed addition. */
+
+  // affine coordinates of the groups that support batch-affine buckets
+  template<typename G>
+  struct AffineCoords {
+    static const bool available = false;
+  };
+
+#ifdef CURVE_BN128
+  template<>
+  struct AffineCoords<libff::bn128_G1> {
+    static const bool available = true;
+    using F = bn::Fp;
+    static F one() { return F(1); }
+    static void invert(F &a) { a.inverse(); }
+    static libff::bn128_G1 fromAffine(const F &x, const F &y)
+    {
+      libff::bn128_G1 g;
+      g.X = x;
+      g.Y = y;
+      g.Z = one();
+      return g;
+    }
+  };
+#endif
+
+#ifdef CURVE_ALT_BN128
+  template<>
+  struct AffineCoords<libff::alt_bn128_G1> {
+    static const bool available = true;
+    using F = libff::alt_bn128_Fq;
+    static F one() { return F::one(); }
+    static void invert(F &a) { a = a.inverse(); }
+    static libff::alt_bn128_G1 fromAffine(const F &x, const F &y)
+    {
+      return libff::alt_bn128_G1(x, y, one());
+    }
+  };
+#endif
+
+  // pending bucket additions between two shared inversions
+  const size_t BATCH_AFFINE_SIZE = 512;
+
+  /* as bucketWindowSum, for affine (special) bases. An addition to a bucket that already has one in the
+   * batch goes to a projective spill bucket (a mixed addition) rather than waiting: digits that repeat
+   * (0/1 or equal scalars) would otherwise pile up behind a batch that never fills.
+   * Terms as in bucketWindowSum (GLV terms of bases when negs is given). */
+  template<typename G, mp_size_t N>
+  G batchAffineWindowSum(const G *bases, const libff::bigint<N> *exps, const char *negs, size_t n, size_t offset, size_t c)
+  {
+    using AC = AffineCoords<G>;
+    using F = typename AC::F;
+    const size_t nBuckets = (size_t(1) << c) - 1;
+
+    vector<F> bx(nBuckets), by(nBuckets);
+    vector<char> empty(nBuckets, 1), inBatch(nBuckets, 0);
+    vector<std::pair<size_t, G>> batch; // (bucket, term)
+    vector<G> spill; // allocated on the first collision
+    vector<F> num, den;
+    vector<char> cancels;
+    batch.reserve(BATCH_AFFINE_SIZE);
+
+    // either fills an empty bucket, queues the addition, or spills it if the bucket is already queued
+    auto schedule = [&](size_t b, const G &q) {
+      if (inBatch[b]) {
+        if (spill.empty()) {
+          spill.assign(nBuckets, G::zero());
+        }
+        bucketAdd<true>(spill[b], q);
+      } else if (empty[b]) {
+        bx[b] = q.X;
+        by[b] = q.Y;
+        empty[b] = 0;
+      } else {
+        inBatch[b] = 1;
+        batch.emplace_back(b, q);
+      }
+    };
+
+    auto flush = [&]() {
+      const size_t k = batch.size();
+      num.resize(k);
+      den.resize(k);
+      cancels.assign(k, 0);
+      for (size_t t = 0; t < k; t++) {
+        const size_t b = batch[t].first;
+        const G &q = batch[t].second;
+        if (bx[b] == q.X) {
+          if (by[b] == q.Y) { // doubling: lambda = 3x^2/2y
+            auto xx = bx[b]*bx[b];
+            num[t] = xx + xx + xx;
+            den[t] = by[b] + by[b];
+          } else { // P + (-P)
+            cancels[t] = 1;
+            num[t] = den[t] = AC::one();
+          }
+        } else { // lambda = (y2-y1)/(x2-x1)
+          num[t] = q.Y - by[b];
+          den[t] = q.X - bx[b];
+        }
+      }
+
+      // Montgomery's trick: invert the product, then peel off one denominator at a time
+      vector<F> prefix(k);
+      F acc = AC::one();
+      for (size_t t = 0; t < k; t++) {
+        prefix[t] = acc;
+        acc = acc*den[t];
+      }
+      AC::invert(acc);
+      for (size_t t = k; t-- > 0; ) {
+        F inv = acc*prefix[t];
+        acc = acc*den[t];
+        const size_t b = batch[t].first;
+        inBatch[b] = 0;
+        if (cancels[t]) {
+          empty[b] = 1;
+          continue;
+        }
+        const G &q = batch[t].second;
+        F lambda = num[t]*inv;
+        F x3 = lambda*lambda - bx[b] - q.X;
+        by[b] = lambda*(bx[b] - x3) - by[b];
+        bx[b] = x3;
+      }
+      batch.clear();
+    };
+
+    for (size_t e = 0; e < n; e++) {
+      auto d = windowDigit(exps[e], offset, c);
+      if (d == 0 || bases[negs ? e/2 : e].is_zero()) {
+        continue;
+      }
+      schedule(d-1, negs ? glvTerm(bases, e, negs[e]) : bases[e]);
+      if (batch.size() >= BATCH_AFFINE_SIZE) {
+        flush();
+      }
+    }
+    flush();
+
+    G running = G::zero();
+    G acc = G::zero();
+    for (size_t b = nBuckets; b-- > 0; ) {
+      if (!empty[b]) {
+        running = running.mixed_add(AC::fromAffine(bx[b], by[b]));
+      }
+      if (!spill.empty()) {
+        running = running + spill[b];
+      }
+      acc = acc + running;
+    }
+    return acc;
+  }
+
+  // Pippenger with batch-affine buckets; plain Pippenger for groups without AffineCoords
+  template<typename G, typename FieldT>
+  G batchAffinePippenger(const G *bases, const FieldT *scalars, size_t n, size_t c, size_t chunks)
+  {
+    if constexpr (!AffineCoords<G>::available) {
+      return pippenger(bases, scalars, n, c, chunks);
+    } else {
+      using BigT = libff::bigint<FieldT::num_limbs>;
+
+      // bases have to be affine: normalize a copy if some are not
+      vector<G> normalized;
+      if (!allAffine(bases, n)) {
+        normalized.assign(bases, bases+n);
+        libff::batch_to_special(normalized);
+        bases = normalized.data();
+      }
+
+      size_t nBits = scalarBits(scalars, n);
+
+      // negation and the endomorphism keep the bases affine
+      vector<BigT> exps;
+      vector<char> negs;
+      if (useEndo<G>() && nBits > cpglv::HALF_BITS) {
+        glvSplit(scalars, n, chunks, exps, negs);
+        n *= 2;
+        nBits = cpglv::HALF_BITS;
+      } else {
+        exps.resize(n);
+        for (size_t i = 0; i < n; i++) {
+          exps[i] = scalars[i].as_bigint();
+        }
+      }
+      const char *negsPtr = negs.empty() ? nullptr : negs.data();
+
+      if (c == 0) {
+        c = pippengerWindow(n, nBits);
+      }
+      const size_t nWindows = (nBits + c - 1) / c;
+      vector<G> windowSums(nWindows);
+      forEach(nWindows, chunks, [&](size_t j) {
+        windowSums[j] = batchAffineWindowSum(bases, exps.data(), negsPtr, n, j*c, c);
+      });
+      return combineWindows(windowSums, c);
+    }
+  }
+
+  /* k multiexps sharing one base vector: out[t] is the multiexp of xss[t] over the first xss[t]->size() bases.
+   * Every window streams the bases once for all k vectors (one bucket set each) instead of k times.
+   * With GLV the terms are P_i and phi(P_i), and the sign of each half goes to the bucket operation. */
+  template<typename G, typename FieldT>
+  vector<G> pippengerMulti(const G *bases, size_t nBases, const vector<const vector<FieldT> *> &xss, size_t c, size_t chunks)
+  {
+    using BigT = libff::bigint<FieldT::num_limbs>;
+    const size_t k = xss.size();
+
+    vector<size_t> lens(k);
+    size_t maxLen = 0;
+    for (size_t t = 0; t < k; t++) {
+      lens[t] = std::min(nBases, xss[t]->size());
+      maxLen = std::max(maxLen, lens[t]);
+    }
+
+    // exps[(i*nTerms + h)*k + t]: scalars of the same term next to each other
+    vector<BigT> exps(maxLen*k);
+    for (size_t t = 0; t < k; t++) {
+      for (size_t i = 0; i < lens[t]; i++) {
+        exps[i*k + t] = (*xss[t])[i].as_bigint();
+      }
+    }
+    size_t nBits = scalarBits(exps.data(), exps.size(), FieldT::size_in_bits());
+    const bool glv = useEndo<G>() && nBits > cpglv::HALF_BITS;
+    const size_t nTerms = glv ? 2 : 1; // terms per base
+
+    vector<char> negs;
+    if (glv) {
+      if constexpr (cpglv::Endo<G>::available) {
+        nBits = cpglv::HALF_BITS;
+        exps.assign(2*maxLen*k, BigT());
+        negs.resize(exps.size());
+        forEach(maxLen, chunks, [&](size_t i) {
+          for (size_t t = 0; t < k; t++) {
+            if (i >= lens[t]) {
+              continue;
+            }
+            auto sp = cpglv::split((*xss[t])[i]);
+            exps[(2*i)*k + t] = sp.k1;
+            negs[(2*i)*k + t] = sp.neg1;
+            exps[(2*i+1)*k + t] = sp.k2;
+            negs[(2*i+1)*k + t] = sp.neg2;
+          }
+        });
+      }
+    }
+
+    if (c == 0) {
+      c = pippengerWindow(maxLen*nTerms, nBits, true);
+    }
+    const size_t nWindows = signedWindows(nBits, c);
+    const size_t nBuckets = size_t(1) << (c-1);
+
+    vector<char> carries(exps.size()*nWindows);
+    forEach(exps.size(), chunks, [&](size_t e) {
+      signedCarries(exps[e], nWindows, c, &carries[e*nWindows]);
+    });
+
+    const bool affine = allAffine(bases, maxLen);
+    auto add = [affine](G &bucket, const G &base) {
+      if (affine) {
+        bucketAdd<true>(bucket, base);
+      } else {
+        bucketAdd<false>(bucket, base);
+      }
+    };
+
+    vector<vector<G>> windowSums(nWindows, vector<G>(k));
+    forEach(nWindows, chunks, [&](size_t j) {
+      vector<G> buckets(k*nBuckets, G::zero());
+      for (size_t i = 0; i < maxLen*nTerms; i++) {
+        G phi;
+        if (glv && (i & 1)) {
+          phi = glvTerm(bases, i, false);
+        }
+        const G &base = !glv ? bases[i] : (i & 1) ? phi : bases[i/2];
+        for (size_t t = 0; t < k; t++) {
+          if (i/nTerms >= lens[t]) {
+            continue;
+          }
+          const size_t e = i*k + t;
+          auto d = signedDigit(exps[e], carries[e*nWindows + j], j, nWindows, c);
+          if (d == 0) {
+            continue;
+          }
+          const bool neg = (d < 0) != (glv && negs[e]);
+          if (neg) {
+            add(buckets[t*nBuckets + std::labs(d)-1], -base);
+          } else {
+            add(buckets[t*nBuckets + std::labs(d)-1], base);
+          }
+        }
+      }
+      for (size_t t = 0; t < k; t++) {
+        G running = G::zero();
+        G acc = G::zero();
+        for (size_t b = nBuckets; b-- > 0; ) {
+          running = running + buckets[t*nBuckets + b];
+          acc = acc + running;
+        }
+        windowSums[j][t] = acc;
+      }
+    });
+
+    vector<G> out(k);
+    for (size_t t = 0; t < k; t++) {
+      vector<G> sums(nWindows);
+      for (size_t j = 0; j < nWindows; j++) {
+        sums[j] = windowSums[j][t];
+      }
+      out[t] = combineWindows(sums, c);
+    }
+    return out;
+  }
+
+  template<typename G, typename FieldT>
+  G naive(const G *bases, const FieldT *scalars, size_t n)
+  {
+    G acc = G::zero();
+    for (size_t i = 0; i < n; i++) {
+      acc = acc + scalars[i]*bases[i];
+    }
+    return acc;
+  }
+
+  /* Fixed-base tables: for every base P we keep 2^(c*j)*P for each window j,
+   * so that a multiexp is a single bucket pass over n*nWindows points with no doublings. */
+  template<typename G>
+  struct FixedBaseTable {
+    size_t c = 0;
+    size_t nWindows = 0;
+    size_t n = 0;
+    vector<G> shifted; // shifted[i*nWindows + j] = 2^(c*j) * bases[i]
+
+    bool empty() const { return n == 0; }
+    size_t sizeInPoints() const { return shifted.size(); }
+  };
+
+  template<typename G>
+  FixedBaseTable<G> mkFixedBaseTable(cputil::Span<G> bases, size_t c, size_t nBits, size_t chunks)
+  {
+    FixedBaseTable<G> tbl;
+    tbl.n = bases.size();
+    tbl.c = (c == 0) ? fixedBaseWindow(tbl.n, nBits, chunks) : c;
+    tbl.nWindows = (nBits + tbl.c - 1) / tbl.c;
+    tbl.shifted.resize(tbl.n*tbl.nWindows);
+
+    forEach(tbl.n, chunks, [&](size_t i) {
+      G cur = bases[i];
+      for (size_t j = 0; j < tbl.nWindows; j++) {
+        tbl.shifted[i*tbl.nWindows + j] = cur;
+        for (size_t k = 0; k < tbl.c; k++) {
+          cur = cur.dbl();
+        }
+      }
+    });
+    // all entries in affine form so that buckets can use mixed additions
+    libff::batch_to_special(tbl.shifted);
+    return tbl;
+  }
+
+  template<typename G, typename FieldT>
+  G fixedBaseMultiExp(
+    const FixedBaseTable<G> &tbl, const vector<FieldT> &xs, size_t n, size_t chunks,
+    const char *site = "fixedBaseMultiExp")
+  {
+    using BigT = libff::bigint<FieldT::num_limbs>;
+    n = std::min(n, tbl.n);
+    if (n == 0) {
+      return G::zero();
+    }
+    cpstats::Record rec(site);
+    rec.size(n);
+    rec.method("fixed_base");
+    const size_t c = tbl.c;
+    const size_t nW = tbl.nWindows;
+
+    // each chunk works on a slice of the bases with its own buckets
+    chunks = std::max<size_t>(1, std::min(chunks, n));
+    rec.chunks(chunks);
+    vector<G> partial(chunks, G::zero());
+    forEach(chunks, chunks, [&](size_t t) {
+      const size_t from = n*t/chunks;
+      const size_t to = n*(t+1)/chunks;
+      vector<G> buckets((size_t(1) << c) - 1, G::zero());
+      for (size_t i = from; i < to; i++) {
+        BigT e = xs[i].as_bigint();
+        const G *row = &tbl.shifted[i*nW];
+        const size_t nWi = std::min(nW, (e.num_bits() + c - 1) / c); // short scalars stop early
+        for (size_t j = 0; j < nWi; j++) {
+          auto d = windowDigit(e, j*c, c);
+          if (d != 0) {
+            buckets[d-1] = buckets[d-1].mixed_add(row[j]);
+          }
+        }
+      }
+      G running = G::zero();
+      G acc = G::zero();
+      for (size_t k = buckets.size(); k-- > 0; ) {
+        running = running + buckets[k];
+        acc = acc + running;
+      }
+      partial[t] = acc;
+    });
+
+    G res = G::zero();
+    for (auto &p : partial) {
+      res = res + p;
+    }
+    return res;
+  }
+
+  // libff method on chunks slices of the input, one pool task each
+  template<typename G, typename FieldT, libff::multi_exp_method LibMethod>
+  G libffMultiExp(const vector<G> &gs, const vector<FieldT> &xs, size_t n, size_t chunks, bool skipTrivial)
+  {
+    chunks = std::max<size_t>(1, std::min(chunks, n));
+    vector<G> partial(chunks, G::zero());
+    forEach(chunks, chunks, [&](size_t t) {
+      auto from = n*t/chunks;
+      auto to = n*(t+1)/chunks;
+      if (skipTrivial) {
+        partial[t] = libff::multi_exp_with_mixed_addition<G, FieldT, LibMethod>(
+          gs.begin()+from, gs.begin()+to, xs.begin()+from, xs.begin()+to, 1);
+      } else {
+        partial[t] = libff::multi_exp<G, FieldT, LibMethod>(
+          gs.begin()+from, gs.begin()+to, xs.begin()+from, xs.begin()+to, 1);
+      }
+    });
+
+    G res = G::zero();
+    for (auto &p : partial) {
+      res = res + p;
+    }
+    return res;
+  }
+
+  /* Multiexp over the first n bases/scalars.
+   * fallback is the libff method used under Auto for small inputs;
+   * skipTrivial filters out 0/1 scalars before a libff method (their "mixed addition" variant).
+   * site names the caller in the instrumentation counters; preferred is used unless a method is forced.
+   * gsVec: the bases gs as a vector if they are one (libff methods need vector iterators), else nullptr */
+  template<typename G, typename FieldT>
+  G multiExpAt(
+    const G *gs, const vector<G> *gsVec, const vector<FieldT> &xs, size_t n, size_t chunks,
+    Method fallback, bool skipTrivial, const char *site, Method preferred)
+  {
+    if (n == 0) {
+      return G::zero();
+    }
+
+    const Method m = chooseMethod(n, fallback, preferred);
+    cpstats::Record rec(site);
+    if (cpstats::enabled()) {
+      rec.size(n);
+      rec.chunks(chunks);
+      rec.method(methodName(m));
+      rec.classify(xs.data(), n);
+    }
+
+    vector<G> copy;
+    if (!gsVec && (m == Method::BosCoster || m == Method::BDLO12)) {
+      copy.assign(gs, gs + n);
+      gsVec = &copy;
+    }
+    switch (m) {
+      case Method::Naive:
+        return naive(gs, xs.data(), n);
+      case Method::BosCoster:
+        return libffMultiExp<G, FieldT, libff::multi_exp_method_bos_coster>(*gsVec, xs, n, chunks, skipTrivial);
+      case Method::BDLO12:
+        return libffMultiExp<G, FieldT, libff::multi_exp_method_BDLO12>(*gsVec, xs, n, chunks, skipTrivial);
+      case Method::BatchAffine:
+        return batchAffinePippenger(gs, xs.data(), n, config().window, chunks);
+      case Method::Pippenger:
+      default:
+        return pippenger(gs, xs.data(), n, config().window, chunks);
+    }
+  }
+
+  // multiExpAt on bases in a vector
+  template<typename G, typename FieldT>
+  G multiExp(
+    const vector<G> &gs, const vector<FieldT> &xs, size_t n, size_t chunks,
+    Method fallback, bool skipTrivial, const char *site = "multiExp", Method preferred = Method::Auto)
+  {
+    return multiExpAt(gs.data(), &gs, xs, n, chunks, fallback, skipTrivial, site, preferred);
+  }
+
+  // as multiExp, on bases read through a view (e.g. of a mapped key); only the libff methods copy them
+  template<typename G, typename FieldT>
+  G multiExp(
+    cputil::Span<G> gs, const vector<FieldT> &xs, size_t n, size_t chunks,
+    Method fallback, bool skipTrivial, const char *site = "multiExp", Method preferred = Method::Auto)
+  {
+    return multiExpAt(gs.data(), static_cast<const vector<G> *>(nullptr), xs, n, chunks, fallback, skipTrivial, site, preferred);
+  }
+
+  /* One multiexp per vector of xss over a prefix of the nGs shared bases gs.
+   * Under Pippenger the vectors are processed together; otherwise one multiExpAt each
+   * (the libff methods need the bases in a vector of their own, so those get a copy). */
+  template<typename G, typename FieldT>
+  vector<G> multiExpMulti(
+    const G *gs, size_t nGs, const vector<const vector<FieldT> *> &xss, size_t chunks,
+    Method fallback, bool skipTrivial, const char *site = "multiExpMulti")
+  {
+    size_t maxLen = 0;
+    for (auto xs : xss) {
+      maxLen = std::max(maxLen, std::min(nGs, xs->size()));
+    }
+    if (xss.size() > 1 && chooseMethod(maxLen, fallback) == Method::Pippenger) {
+      cpstats::Record rec(site);
+      if (cpstats::enabled()) {
+        rec.chunks(chunks);
+        rec.method("pippenger_multi");
+        for (auto xs : xss) {
+          auto n = std::min(nGs, xs->size());
+          rec.size(n);
+          rec.classify(xs->data(), n);
+        }
+      }
+      return pippengerMulti(gs, nGs, xss, config().window, chunks);
+    }
+
+    vector<G> out;
+    out.reserve(xss.size());
+    for (auto xs : xss) {
+      out.push_back(multiExpAt(
+        gs, static_cast<const vector<G> *>(nullptr), *xs, std::min(nGs, xs->size()), chunks,
+        fallback, skipTrivial, site, Method::Auto));
+    }
+    return out;
+  }
+
+} // end namespace cpmexp
+
+#endif
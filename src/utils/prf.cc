@@ -0,0 +1,82 @@
+#include "prf.h"
+
+#include <stdexcept>
+#include <cstring>
+
+namespace cpprf {
+
+  namespace {
+    inline uint32_t rotl(uint32_t x, int k)
+    {
+      return (x << k) | (x >> (32 - k));
+    }
+
+    inline void quarterRound(uint32_t *s, int a, int b, int c, int d)
+    {
+      s[a] += s[b]; s[d] = rotl(s[d] ^ s[a], 16);
+      s[c] += s[d]; s[b] = rotl(s[b] ^ s[c], 12);
+      s[a] += s[b]; s[d] = rotl(s[d] ^ s[a], 8);
+      s[c] += s[d]; s[b] = rotl(s[b] ^ s[c], 7);
+    }
+
+    inline uint32_t load32(const uint8_t *p)
+    {
+      return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+
+    int hexDigit(char c)
+    {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      throw std::invalid_argument("Seed is not hexadecimal");
+    }
+  }
+
+  Seed seedFromHex(const std::string &hex)
+  {
+    if (hex.size() > 64) {
+      throw std::invalid_argument("Seed longer than 256 bits");
+    }
+    Seed seed{};
+    for (size_t i = 0; i < hex.size(); i++) {
+      seed[i/2] |= uint8_t(hexDigit(hex[i]) << ((i % 2) ? 0 : 4));
+    }
+    return seed;
+  }
+
+  // RFC 7539 block function, with a 64-bit counter and a 64-bit stream id as nonce
+  void chacha20Block(const Seed &seed, uint64_t stream, uint64_t counter, uint8_t out[64])
+  {
+    uint32_t in[16];
+    in[0] = 0x61707865; in[1] = 0x3320646e; in[2] = 0x79622d32; in[3] = 0x6b206574;
+    for (size_t i = 0; i < 8; i++) {
+      in[4+i] = load32(&seed[4*i]);
+    }
+    in[12] = uint32_t(counter);
+    in[13] = uint32_t(counter >> 32);
+    in[14] = uint32_t(stream);
+    in[15] = uint32_t(stream >> 32);
+
+    uint32_t s[16];
+    memcpy(s, in, sizeof(s));
+    for (int r = 0; r < 10; r++) {
+      quarterRound(s, 0, 4, 8, 12);
+      quarterRound(s, 1, 5, 9, 13);
+      quarterRound(s, 2, 6, 10, 14);
+      quarterRound(s, 3, 7, 11, 15);
+      quarterRound(s, 0, 5, 10, 15);
+      quarterRound(s, 1, 6, 11, 12);
+      quarterRound(s, 2, 7, 8, 13);
+      quarterRound(s, 3, 4, 9, 14);
+    }
+    for (size_t i = 0; i < 16; i++) {
+      const uint32_t v = s[i] + in[i];
+      out[4*i] = uint8_t(v);
+      out[4*i+1] = uint8_t(v >> 8);
+      out[4*i+2] = uint8_t(v >> 16);
+      out[4*i+3] = uint8_t(v >> 24);
+    }
+  }
+
+} // end namespace cpprf
@@ -0,0 +1,55 @@
+#ifndef CP_PRF_H
+#define CP_PRF_H
+
+/* Deterministic field elements from a 256-bit seed: ChaCha20 keystream, one 64-byte block per element
+ * (512 bits reduced into the field, so the bias is negligible). Element i of a stream depends on
+ * (seed, stream, i) only, so any slice can be derived on its own and in parallel. */
+
+#include "threadpool.h"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace cpprf {
+  using std::vector;
+  using std::size_t;
+
+  using Seed = std::array<uint8_t, 32>;
+
+  // seed from up to 64 hex digits (missing ones are zeros)
+  Seed seedFromHex(const std::string &hex);
+
+  // the counter-th 64-byte keystream block of stream under seed
+  void chacha20Block(const Seed &seed, uint64_t stream, uint64_t counter, uint8_t out[64]);
+
+  template<typename FieldT>
+  FieldT fieldElement(const Seed &seed, uint64_t stream, uint64_t index)
+  {
+    uint8_t block[64];
+    chacha20Block(seed, stream, index, block);
+    const FieldT two32 = FieldT(long(1) << 32);
+    FieldT x = FieldT::zero();
+    for (size_t w = 0; w < 16; w++) {
+      const long word = long(block[4*w]) | long(block[4*w+1]) << 8 | long(block[4*w+2]) << 16 | long(block[4*w+3]) << 24;
+      x = x*two32 + FieldT(word);
+    }
+    return x;
+  }
+
+  // elements 0..n-1 of stream, derived on the thread pool
+  template<typename FieldT>
+  vector<FieldT> fieldElements(const Seed &seed, uint64_t stream, size_t n)
+  {
+    vector<FieldT> xs(n);
+    cppool::parallelFor(n, [&](size_t i) {
+      xs[i] = fieldElement<FieldT>(seed, stream, i);
+    }, 256);
+    return xs;
+  }
+
+} // end namespace cpprf
+
+#endif
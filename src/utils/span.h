@@ -0,0 +1,49 @@
+#ifndef CP_SPAN_H
+#define CP_SPAN_H
+
+/* Read-only view of contiguous elements (std::span is C++20).
+ * Views into a key stay valid as long as the key is alive and not resized. */
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+namespace cputil {
+
+  template<typename T>
+  class Span {
+  public:
+    Span() : ptr(nullptr), len(0) { }
+    Span(const T *_ptr, std::size_t _len) : ptr(_ptr), len(_len) { }
+    Span(const std::vector<T> &v) : ptr(v.data()), len(v.size()) { }
+
+    const T *data() const { return ptr; }
+    std::size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    const T &operator[](std::size_t i) const { return ptr[i]; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + len; }
+
+    // the cnt elements from offset on
+    Span subspan(std::size_t offset, std::size_t cnt) const
+    {
+      if (offset + cnt > len) {
+        throw std::out_of_range("Span::subspan out of range");
+      }
+      return Span(ptr + offset, cnt);
+    }
+
+    Span first(std::size_t cnt) const { return subspan(0, cnt); }
+
+    // an owning copy, for the APIs that need one
+    std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+  private:
+    const T *ptr;
+    std::size_t len;
+  };
+
+} // end namespace cputil
+
+#endif
@@ -2,22 +2,14 @@
 
 LG1 simplesparsemexp(const vector<LG1> &bases, const vector<CoeffPos<LFr>> &cps)
 {
-	#ifdef MULTICORE
-    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
-	#else
-    const size_t chunks = 1;
-	#endif
+    const size_t chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
 	
 	return sparsemexpS<LG1, LFr, multi_exp_method_BDLO12>(bases, cps, chunks);
 }
 
 LG1 simplesparsemexp(const vector<CoeffPos<LG1>> &cps, const vector<LFr> &exps)
 {
-	#ifdef MULTICORE
-    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
-	#else
-    const size_t chunks = 1;
-	#endif
+    const size_t chunks = cppool::numThreads(); // to override, set LEGO_NUM_THREADS or call cppool::setNumThreads()
 	
 	return sparsemexpG<LG1, LFr, multi_exp_method_BDLO12>(cps, exps, chunks);
 	
@@ -10,83 +10,119 @@
 using namespace libff;
 
 template<typename T, typename FieldT, multi_exp_method Method>
-T sparsemexpS(const vector<T> &bases, const vector<CoeffPos<FieldT>> &cps, const size_t chunks)
+T sparsemexpS(const vector<T> &bases, const vector<CoeffPos<FieldT>> &cps, const size_t chunks, const char *site = "sparsemexpS")
 {
 
     const FieldT zero = FieldT::zero();
     const FieldT one = FieldT::one();
-    
-    std::vector<FieldT> p;
-    std::vector<T> g;
 
-    T acc = T::zero();
+    // each chunk filters and exponentiates its own slice of cps
+    const size_t n = cps.size();
+    const size_t nChunks = std::max<size_t>(1, std::min(chunks, n));
+    cpstats::Record rec(site);
+    if (cpstats::enabled()) {
+      rec.size(n);
+      rec.chunks(nChunks);
+      rec.method(cpmexp::methodName(Method));
+    }
+    vector<T> partial(nChunks, T::zero());
+    vector<size_t> skips(nChunks, 0), adds(nChunks, 0), others(nChunks, 0);
 
-    size_t num_skip = 0;
-    size_t num_add = 0;
-    size_t num_other = 0;
+    cpmexp::forEach(nChunks, nChunks, [&](size_t t) {
+        std::vector<FieldT> p;
+        std::vector<T> g;
+        T acc = T::zero();
 
-    for (auto cp : cps)
-    {
-				auto curBase = bases[cp.pos];
-        if (cp.val == zero)
-        {
-            // do nothing
-            ++num_skip;
-        }
-        else if (cp.val == one)
+        for (size_t i = n*t/nChunks; i < n*(t+1)/nChunks; i++)
         {
-          
+            auto &cp = cps[i];
+            auto &curBase = bases[cp.pos];
+            if (cp.val == zero)
+            {
+                // do nothing
+                ++skips[t];
+            }
+            else if (cp.val == one)
+            {
+
 #ifdef USE_MIXED_ADDITION
-            acc = acc.mixed_add(curBase);
+                acc = acc.mixed_add(curBase);
 #else
 
-            acc = acc + (curBase);
+                acc = acc + (curBase);
 #endif
-            ++num_add;
-        }
-        else
-        {
-            p.push_back(cp.val);
-            g.push_back(curBase);
-            ++num_other;
+                ++adds[t];
+            }
+            else
+            {
+                p.push_back(cp.val);
+                g.push_back(curBase);
+                ++others[t];
+            }
         }
+        partial[t] = acc + multi_exp<T, FieldT, Method>(begin(g), end(g), begin(p), end(p), 1);
+    });
+
+    T acc = T::zero();
+    for (size_t t = 0; t < nChunks; t++) {
+        rec.split(skips[t], adds[t], others[t]);
+        acc = acc + partial[t];
     }
-    print_indent(); printf("* Elements of w skipped: %zu (%0.2f%%)\n", num_skip, 100.*num_skip/(num_skip+num_add+num_other));
-    print_indent(); printf("* Elements of w processed with special addition: %zu (%0.2f%%)\n", num_add, 100.*num_add/(num_skip+num_add+num_other));
-    print_indent(); printf("* Elements of w remaining: %zu (%0.2f%%)\n", num_other, 100.*num_other/(num_skip+num_add+num_other));
 
-    return acc + multi_exp<T, FieldT, Method>(begin(g), end(g), begin(p), end(p), chunks);
+    return acc;
 }
 
 
 template<typename T, typename FieldT, multi_exp_method Method>
-T sparsemexpG(const vector<CoeffPos<T>> &cps, const vector<FieldT> &exps, const size_t chunks)
+T sparsemexpG(const vector<CoeffPos<T>> &cps, const vector<FieldT> &exps, const size_t chunks, const char *site = "sparsemexpG")
 {
 
     const T zero = T::zero();
     const T one = T::one();
-    
-    std::vector<FieldT> p;
-    std::vector<T> g;
-
-    FieldT acc = FieldT::zero();
-
-    for (auto cp : cps)
-    {
-      auto curExp = exps[cp.pos];
-    
-      if (cp.val == zero) {
-        // do nothing
-      } else if (cp.val == one) {
-        // increase acc
-        acc += curExp;
-      } else {
-        g.push_back(cp.val);
-        p.push_back(curExp);
-      }
+
+    const size_t n = cps.size();
+    const size_t nChunks = std::max<size_t>(1, std::min(chunks, n));
+    vector<T> partial(nChunks, T::zero());
+    vector<size_t> skips(nChunks, 0), adds(nChunks, 0), others(nChunks, 0);
+    cpstats::Record rec(site);
+    if (cpstats::enabled()) {
+      rec.size(n);
+      rec.chunks(nChunks);
+      rec.method(cpmexp::methodName(Method));
+    }
+
+    cpmexp::forEach(nChunks, nChunks, [&](size_t t) {
+        std::vector<FieldT> p;
+        std::vector<T> g;
+        FieldT acc = FieldT::zero();
+
+        for (size_t i = n*t/nChunks; i < n*(t+1)/nChunks; i++)
+        {
+          auto &cp = cps[i];
+          auto curExp = exps[cp.pos];
+
+          if (cp.val == zero) {
+            // do nothing
+            ++skips[t];
+          } else if (cp.val == one) {
+            // increase acc
+            acc += curExp;
+            ++adds[t];
+          } else {
+            g.push_back(cp.val);
+            p.push_back(curExp);
+            ++others[t];
+          }
+        }
+        partial[t] = acc*one + multi_exp<T, FieldT, Method>(begin(g), end(g), begin(p), end(p), 1);
+    });
+
+    T res = T::zero();
+    for (size_t t = 0; t < nChunks; t++) {
+      rec.split(skips[t], adds[t], others[t]);
+      res = res + partial[t];
     }
-  
-    return acc*one + multi_exp<T, FieldT, Method>(begin(g), end(g), begin(p), end(p), chunks);
+    return res;
 }
 
 LG1 simplesparsemexp(const vector<LG1> &bases, const vector<CoeffPos<LFr>> &cps);
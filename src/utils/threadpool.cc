@@ -0,0 +1,272 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace cppool {
+  using std::vector;
+
+  namespace {
+
+    struct Group {
+      std::atomic<size_t> pending{0};
+      std::mutex errMtx;
+      std::exception_ptr error;
+    };
+
+    struct Task {
+      const std::function<void()> *fn;
+      Group *grp;
+    };
+
+    /* Every worker owns a deque: it pushes and pops at the back, idle threads steal from the front.
+     * Threads outside the pool share one extra deque. */
+    class Pool {
+    public:
+      explicit Pool(size_t n) : nThreads(n)
+      {
+        for (size_t q = 0; q < n; q++) {
+          queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+        for (size_t id = 0; id+1 < n; id++) {
+          workers.emplace_back([this, id]() { workerLoop(id); });
+        }
+      }
+
+      ~Pool()
+      {
+        {
+          std::lock_guard<std::mutex> lk(sleepMtx);
+          stopping = true;
+        }
+        sleepCv.notify_all();
+        for (auto &w : workers) {
+          w.join();
+        }
+      }
+
+      size_t size() const { return nThreads; }
+
+      void run(const vector<std::function<void()>> &fns);
+
+    private:
+      struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+      };
+
+      const size_t nThreads;
+      vector<std::unique_ptr<Queue>> queues; // queues[nThreads-1] is for threads outside the pool
+      vector<std::thread> workers;
+
+      std::mutex sleepMtx;
+      std::condition_variable sleepCv;
+      std::atomic<size_t> queued{0};
+      bool stopping = false;
+
+      size_t externalQueue() const { return nThreads-1; }
+      bool tryPop(size_t self, Task &t);
+      void execute(const Task &t);
+      void workerLoop(size_t id);
+    };
+
+    thread_local Pool *curPool = nullptr;
+    thread_local size_t curId = 0;
+
+    bool Pool::tryPop(size_t self, Task &t)
+    {
+      for (size_t k = 0; k < nThreads; k++) {
+        auto &q = *queues[(self + k) % nThreads];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        if (q.tasks.empty()) {
+          continue;
+        }
+        if (k == 0) { // own work: newest first
+          t = q.tasks.back();
+          q.tasks.pop_back();
+        } else { // stealing: oldest first, usually the largest
+          t = q.tasks.front();
+          q.tasks.pop_front();
+        }
+        queued--;
+        return true;
+      }
+      return false;
+    }
+
+    void Pool::execute(const Task &t)
+    {
+      try {
+        (*t.fn)();
+      } catch (...) {
+        std::lock_guard<std::mutex> lk(t.grp->errMtx);
+        if (!t.grp->error) {
+          t.grp->error = std::current_exception();
+        }
+      }
+      // the group may be gone right after this
+      t.grp->pending--;
+    }
+
+    void Pool::workerLoop(size_t id)
+    {
+      curPool = this;
+      curId = id;
+#ifdef MULTICORE
+      // OpenMP regions reached from a task (e.g. in libff) must not spawn threads of their own
+      omp_set_num_threads(1);
+#endif
+      while (true) {
+        Task t;
+        if (tryPop(id, t)) {
+          execute(t);
+          continue;
+        }
+        std::unique_lock<std::mutex> lk(sleepMtx);
+        sleepCv.wait(lk, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+          return;
+        }
+      }
+    }
+
+    void Pool::run(const vector<std::function<void()>> &fns)
+    {
+      const bool inside = (curPool == this);
+      const size_t self = inside ? curId : externalQueue();
+
+      Group grp;
+      grp.pending = fns.size();
+      {
+        auto &q = *queues[self];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        for (auto &fn : fns) {
+          q.tasks.push_back(Task{&fn, &grp});
+        }
+        queued += fns.size();
+      }
+      {
+        std::lock_guard<std::mutex> lk(sleepMtx);
+      }
+      sleepCv.notify_all();
+
+#ifdef MULTICORE
+      int ompThreads = omp_get_max_threads();
+      if (!inside) {
+        omp_set_num_threads(1);
+      }
+#endif
+      // help until our tasks are done (possibly running someone else's meanwhile)
+      while (grp.pending > 0) {
+        Task t;
+        if (tryPop(self, t)) {
+          execute(t);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+#ifdef MULTICORE
+      if (!inside) {
+        omp_set_num_threads(ompThreads);
+      }
+#endif
+
+      if (grp.error) {
+        std::rethrow_exception(grp.error);
+      }
+    }
+
+    size_t defaultNumThreads()
+    {
+      if (const char *s = getenv("LEGO_NUM_THREADS")) {
+        return std::stoul(s);
+      }
+      return std::thread::hardware_concurrency();
+    }
+
+    std::mutex poolMtx;
+
+    std::unique_ptr<Pool> &poolPtr()
+    {
+      static std::unique_ptr<Pool> p;
+      return p;
+    }
+
+    Pool &pool()
+    {
+      std::lock_guard<std::mutex> lk(poolMtx);
+      auto &p = poolPtr();
+      if (!p) {
+        p.reset(new Pool(std::max<size_t>(1, defaultNumThreads())));
+      }
+      return *p;
+    }
+
+  } // end anonymous namespace
+
+  size_t numThreads()
+  {
+    return pool().size();
+  }
+
+  void setNumThreads(size_t n)
+  {
+    if (n == 0) {
+      throw std::runtime_error("Thread pool needs at least one thread");
+    }
+    std::lock_guard<std::mutex> lk(poolMtx);
+    auto &p = poolPtr();
+    p.reset();
+    p.reset(new Pool(n));
+  }
+
+  void parallelInvoke(const vector<std::function<void()>> &fns)
+  {
+    auto &p = pool();
+    if (p.size() == 1 || fns.size() <= 1) {
+      for (auto &fn : fns) {
+        fn();
+      }
+      return;
+    }
+    p.run(fns);
+  }
+
+  void parallelForRange(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain)
+  {
+    if (n == 0) {
+      return;
+    }
+    // a few slices per thread so that stealing can even out the load
+    grain = std::max<size_t>(1, grain);
+    const size_t nT = numThreads();
+    const size_t maxSlices = (nT == 1) ? 1 : 4*nT;
+    const size_t nSlices = std::min(maxSlices, (n + grain - 1) / grain);
+    if (nSlices <= 1) {
+      body(0, n);
+      return;
+    }
+
+    vector<std::function<void()>> fns;
+    for (size_t s = 0; s < nSlices; s++) {
+      const size_t from = n*s/nSlices;
+      const size_t to = n*(s+1)/nSlices;
+      fns.push_back([&body, from, to]() { body(from, to); });
+    }
+    parallelInvoke(fns);
+  }
+
+} // end namespace cppool
@@ -0,0 +1,43 @@
+#ifndef CP_THREADPOOL_H
+#define CP_THREADPOOL_H
+
+/* Process-wide work-stealing pool shared by the parallel kernels (multiexps, FFTs, sumcheck folding, keygen).
+ * The number of threads is a runtime setting: LEGO_NUM_THREADS, or all hardware threads by default.
+ * Parallel calls made from inside a task are run by the same workers, so nesting never adds threads. */
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace cppool {
+  using std::size_t;
+
+  // slices smaller than this are not worth a task for loops of a few field operations per index
+  const size_t FINE_GRAIN = 1024;
+
+  // threads taking part in a parallel call, the calling one included
+  size_t numThreads();
+
+  // replaces the pool; not to be called while parallel work is running
+  void setNumThreads(size_t n);
+
+  // body(from, to) on consecutive slices of [0, n), each of at least grain indices
+  void parallelForRange(size_t n, const std::function<void(size_t, size_t)> &body, size_t grain = 1);
+
+  // body(i) for every i in [0, n)
+  template<typename F>
+  void parallelFor(size_t n, F body, size_t grain = 1)
+  {
+    parallelForRange(n, [&body](size_t from, size_t to) {
+      for (size_t i = from; i < to; i++) {
+        body(i);
+      }
+    }, grain);
+  }
+
+  // runs all fns, possibly concurrently, and returns when they are all done
+  void parallelInvoke(const std::vector<std::function<void()>> &fns);
+
+} // end namespace cppool
+
+#endif
@@ -21,7 +21,7 @@ namespace cputil {
   using namespace std;
 
   template<typename T, typename U>
-  vector<U> map(const vector <T> &src, function<U(T)> fn)
+  vector<U> map(const vector <T> &src, function<U(const T &)> fn)
   {
     vector<U> res;
     transform(src.begin(), src.end(), back_inserter(res), fn);
@@ -128,9 +128,9 @@ vector<T> simpleBatchExp(const T &base, const vector<FieldT> &exps)
 	n = exps.size();
 	g_exp_count = n;
 	g_window = get_exp_window_size<T>(g_exp_count);
-	g_table = get_window_table(fldBitSz, g_window, base);
+	g_table = mkWindowTable(fldBitSz, g_window, base);
 	
-	return batch_exp(fldBitSz, g_window, g_table, exps);
+	return batchExp(fldBitSz, g_window, g_table, exps);
 }
 
 